@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32)
+	#include <malloc.h>
+#endif
+
+#if defined(__linux__)
+	#include <sys/mman.h>
+#endif
+
+namespace PrimMatrix
+{
+	constexpr size_t cache_line_size = 64;
+	constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+	// Tag for constructors that leave trivially constructible elements uninitialized, for results that are overwritten anyway
+	struct uninitialized_t
+	{
+		explicit uninitialized_t() = default;
+	};
+
+	constexpr uninitialized_t uninitialized{};
+
+	namespace detail
+	{
+		inline void* aligned_allocate(const size_t size, const size_t alignment)
+		{
+#if defined(_WIN32)
+			void* memory = _aligned_malloc(size, alignment);
+#else
+			void* memory = nullptr;
+			if (posix_memalign(&memory, alignment, size) != 0)
+			{
+				memory = nullptr;
+			}
+#endif
+			if (memory == nullptr)
+			{
+				throw std::bad_alloc{};
+			}
+
+			return memory;
+		}
+
+		inline void aligned_deallocate(void* memory) noexcept
+		{
+#if defined(_WIN32)
+			_aligned_free(memory);
+#else
+			std::free(memory);
+#endif
+		}
+
+		// Default-initializes on construct() without arguments, so trivially constructible elements are left
+		// uninitialized when a container is sized; everything else is forwarded to Alloc
+		template <class Alloc>
+		class DefaultInitAllocator : public Alloc
+		{
+			using traits = std::allocator_traits<Alloc>;
+
+		public:
+			template <class U>
+			struct rebind
+			{
+				using other = DefaultInitAllocator<typename traits::template rebind_alloc<U>>;
+			};
+
+			DefaultInitAllocator() = default;
+
+			DefaultInitAllocator(const Alloc& allocator) noexcept :
+				Alloc(allocator)
+			{
+
+			}
+
+			template <class OtherAlloc>
+			DefaultInitAllocator(const DefaultInitAllocator<OtherAlloc>& allocator) noexcept :
+				Alloc(static_cast<const OtherAlloc&>(allocator))
+			{
+
+			}
+
+			template <class U>
+			void construct(U* memory) noexcept(std::is_nothrow_default_constructible<U>::value)
+			{
+				::new (static_cast<void*>(memory)) U;
+			}
+
+			template <class U, class... Args>
+			void construct(U* memory, Args&&... args)
+			{
+				traits::construct(static_cast<Alloc&>(*this), memory, std::forward<Args>(args)...);
+			}
+		};
+
+		template <class Lhs, class Rhs>
+		bool operator==(const DefaultInitAllocator<Lhs>& lhs, const DefaultInitAllocator<Rhs>& rhs) noexcept
+		{
+			return static_cast<const Lhs&>(lhs) == static_cast<const Rhs&>(rhs);
+		}
+
+		template <class Lhs, class Rhs>
+		bool operator!=(const DefaultInitAllocator<Lhs>& lhs, const DefaultInitAllocator<Rhs>& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
+		template <class T>
+		size_t allocation_size(const size_t count)
+		{
+			if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+			{
+				throw std::bad_alloc{};
+			}
+
+			return count * sizeof(T);
+		}
+	}
+
+	// Hands out storage aligned to Alignment bytes, by default a cache line, so SIMD loads never split lines
+	template <class T, size_t Alignment = cache_line_size>
+	class AlignedAllocator
+	{
+		static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment has to be a power of two not weaker than the type's");
+
+	public:
+		using value_type = T;
+
+		template <class U>
+		struct rebind
+		{
+			using other = AlignedAllocator<U, Alignment>;
+		};
+
+		AlignedAllocator() noexcept = default;
+
+		template <class U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+		{
+
+		}
+
+		T* allocate(const size_t count)
+		{
+			return static_cast<T*>(detail::aligned_allocate(detail::allocation_size<T>(count), Alignment));
+		}
+
+		void deallocate(T* memory, size_t) noexcept
+		{
+			detail::aligned_deallocate(memory);
+		}
+	};
+
+	template <class T, class U, size_t Alignment>
+	bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept
+	{
+		return true;
+	}
+
+	template <class T, class U, size_t Alignment>
+	bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept
+	{
+		return false;
+	}
+
+	// Allocations of at least a huge page are huge page aligned and, on Linux, advised to be backed by
+	// transparent huge pages; smaller ones fall back to cache line alignment
+	template <class T>
+	class HugePageAllocator
+	{
+	public:
+		using value_type = T;
+
+		HugePageAllocator() noexcept = default;
+
+		template <class U>
+		HugePageAllocator(const HugePageAllocator<U>&) noexcept
+		{
+
+		}
+
+		T* allocate(const size_t count)
+		{
+			const size_t size = detail::allocation_size<T>(count);
+			if (size < huge_page_size)
+			{
+				return static_cast<T*>(detail::aligned_allocate(size, std::max(cache_line_size, alignof(T))));
+			}
+
+			const size_t rounded_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+			void* memory = detail::aligned_allocate(rounded_size, huge_page_size);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+			madvise(memory, rounded_size, MADV_HUGEPAGE);
+#endif
+			return static_cast<T*>(memory);
+		}
+
+		void deallocate(T* memory, size_t) noexcept
+		{
+			detail::aligned_deallocate(memory);
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept
+	{
+		return true;
+	}
+
+	template <class T, class U>
+	bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept
+	{
+		return false;
+	}
+}
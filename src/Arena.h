@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "Allocator.h"
+
+namespace PrimMatrix
+{
+	// Bump-pointer storage for short-lived matrices, everything is released at once by reset() or by an ArenaScope.
+	// An arena is meant to be used by one thread at a time.
+	class MatrixArena
+	{
+	public:
+		using size_type = size_t;
+
+		struct Marker
+		{
+			size_type block;
+			size_type offset;
+		};
+
+		explicit MatrixArena(const size_type block_size = 4 * 1024 * 1024) :
+			block_size_{ block_size }
+		{
+
+		}
+
+		~MatrixArena()
+		{
+			release();
+		}
+
+		MatrixArena(const MatrixArena&) = delete;
+		MatrixArena& operator=(const MatrixArena&) = delete;
+
+		void* allocate(const size_type size, const size_type alignment)
+		{
+			for (; current_block_ < blocks_.size(); ++current_block_, offset_ = 0)
+			{
+				const Block& block = blocks_[current_block_];
+				const size_type aligned_offset = (offset_ + alignment - 1) / alignment * alignment;
+				if (aligned_offset + size <= block.size)
+				{
+					offset_ = aligned_offset + size;
+					return block.memory + aligned_offset;
+				}
+			}
+
+			// Blocks are cache line aligned, larger alignments get the slack they need
+			const size_type block_size = std::max(block_size_, size + (alignment > cache_line_size ? alignment : 0));
+			blocks_.push_back({ static_cast<char*>(detail::aligned_allocate(block_size, cache_line_size)), block_size });
+
+			current_block_ = blocks_.size() - 1;
+			offset_ = 0;
+			return allocate(size, alignment);
+		}
+
+		Marker marker() const noexcept
+		{
+			return { current_block_, offset_ };
+		}
+
+		// Gives back everything allocated since the marker was taken
+		void rewind(const Marker& marker) noexcept
+		{
+			current_block_ = marker.block;
+			offset_ = marker.offset;
+		}
+
+		// Gives back everything, the blocks are kept for reuse
+		void reset() noexcept
+		{
+			rewind({ 0, 0 });
+		}
+
+		// Gives back everything and frees the blocks
+		void release() noexcept
+		{
+			for (const Block& block : blocks_)
+			{
+				detail::aligned_deallocate(block.memory);
+			}
+
+			blocks_.clear();
+			reset();
+		}
+
+		size_type used() const noexcept
+		{
+			size_type used = offset_;
+			for (size_type block = 0; block < current_block_ && block < blocks_.size(); ++block)
+			{
+				used += blocks_[block].size;
+			}
+
+			return used;
+		}
+
+		size_type capacity() const noexcept
+		{
+			size_type capacity = 0;
+			for (const Block& block : blocks_)
+			{
+				capacity += block.size;
+			}
+
+			return capacity;
+		}
+
+		// Arena picked up by default constructed ArenaAllocators on this thread
+		static MatrixArena*& current() noexcept
+		{
+			thread_local MatrixArena* arena = nullptr;
+			return arena;
+		}
+
+	private:
+		struct Block
+		{
+			char* memory;
+			size_type size;
+		};
+
+		size_type block_size_;
+		std::vector<Block> blocks_;
+		size_type current_block_ = 0;
+		size_type offset_ = 0;
+	};
+
+	// Makes the arena current on this thread; on destruction everything allocated inside the scope is
+	// given back and the previous arena becomes current again. Matrices allocated in the scope must not outlive it.
+	class ArenaScope
+	{
+	public:
+		explicit ArenaScope(MatrixArena& arena) :
+			arena_{ arena },
+			marker_{ arena.marker() },
+			previous_{ MatrixArena::current() }
+		{
+			MatrixArena::current() = &arena_;
+		}
+
+		~ArenaScope()
+		{
+			MatrixArena::current() = previous_;
+			arena_.rewind(marker_);
+		}
+
+		ArenaScope(const ArenaScope&) = delete;
+		ArenaScope& operator=(const ArenaScope&) = delete;
+
+	private:
+		MatrixArena& arena_;
+		MatrixArena::Marker marker_;
+		MatrixArena* previous_;
+	};
+
+	// Allocates from an arena, deallocation is a no-op. Default construction binds to the thread's current arena,
+	// so existing DMatrix constructors work unchanged inside an ArenaScope; without an arena it falls back to the heap.
+	// Assignment does not carry the arena over, a matrix assigned from an arena matrix copies the elements into its
+	// own storage and stays valid after the arena is reset; only swap exchanges the arenas.
+	template <class T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::false_type;
+		using propagate_on_container_move_assignment = std::false_type;
+		using propagate_on_container_swap = std::true_type;
+
+		ArenaAllocator() noexcept :
+			arena_{ MatrixArena::current() }
+		{
+
+		}
+
+		explicit ArenaAllocator(MatrixArena& arena) noexcept :
+			arena_{ &arena }
+		{
+
+		}
+
+		template <class U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept :
+			arena_{ other.arena() }
+		{
+
+		}
+
+		T* allocate(const size_t count)
+		{
+			const size_t size = detail::allocation_size<T>(count);
+			if (arena_ == nullptr)
+			{
+				return std::allocator<T>{}.allocate(count);
+			}
+
+			return static_cast<T*>(arena_->allocate(size, std::max(cache_line_size, alignof(T))));
+		}
+
+		void deallocate(T* memory, const size_t count) noexcept
+		{
+			if (arena_ == nullptr)
+			{
+				std::allocator<T>{}.deallocate(memory, count);
+			}
+		}
+
+		MatrixArena* arena() const noexcept { return arena_; }
+
+	private:
+		MatrixArena* arena_;
+	};
+
+	template <class T, class U>
+	bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+	{
+		return lhs.arena() == rhs.arena();
+	}
+
+	template <class T, class U>
+	bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+}
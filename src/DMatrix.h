@@ -1,8 +1,22 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "Allocator.h"
+#include "Arena.h"
+#include "Execution.h"
 #include "Matrix_Exception.h"
+#include "MatrixExpression.h"
+#include "MatrixView.h"
+#include "StorageOrder.h"
+#include "Transpose.h"
+#include "Gemm.h"
+#include "Symmetric.h"
 
 namespace PrimMatrix
 {
@@ -15,19 +29,32 @@ namespace PrimMatrix
 		}
 	}
 
-	template <class T>
-	class DMatrix
+	namespace detail
 	{
+		// Largest storage a thread keeps around as the scratch of operator*=. Bigger results are allocated each time and
+		// the storage they replace is freed; next to the product of such sizes the allocation does not show
+		constexpr size_t multiplication_scratch_bytes = 64 * 1024;
+	}
+
+	// Order is RowMajor or ColumnMajor; element lists given to constructors and iteration follow the storage order.
+	// Lines (rows or columns) are leading_dimension() elements apart, padded matrices leave a gap after each line
+	template <class T, class Alloc = std::allocator<T>, class Order = RowMajor>
+	class DMatrix : public MatrixExpression<DMatrix<T, Alloc, Order>>
+	{
+		using storage_type = std::vector<T, detail::DefaultInitAllocator<Alloc>>;
+
 	public:
 
 		using value_type = T;
-		using size_type = typename std::vector<T>::size_type;
+		using allocator_type = Alloc;
+		using order_type = Order;
+		using size_type = typename storage_type::size_type;
 		using reference = T&;
 		using const_reference = const T&;
 		using pointer = T*;
 		using const_pointer = const T*;
-		using iterator = typename std::vector<T>::iterator;
-		using const_iterator = typename std::vector<T>::const_iterator;
+		using iterator = StridedIterator<T>;
+		using const_iterator = StridedIterator<const T>;
 
 		enum class EOrientation 
 		{ 
@@ -36,25 +63,56 @@ namespace PrimMatrix
 		};
 
 		/* CONSTRUCTION || DESTRUCTION */
-		explicit DMatrix(const size_type row_count, const size_type column_count) :
+		explicit DMatrix(const size_type row_count, const size_type column_count, const allocator_type& allocator = allocator_type{}) :
 			rows_{ row_count },
 			columns_{ column_count },
-			data_(rows_ * columns_)
+			leading_dimension_{ line_size() },
+			data_(detail::numa_storage(rows_ * columns_, value_type{}, typename storage_type::allocator_type{ allocator }))
 		{ 
 			
 		}
 
-		explicit DMatrix(const size_type row_count, const size_type column_count, const value_type& initial_value) :
+		explicit DMatrix(const size_type row_count, const size_type column_count, const Padding& padding, const allocator_type& allocator = allocator_type{}) :
+			rows_{ row_count },
+			columns_{ column_count },
+			leading_dimension_{ detail::resolve_padding<value_type>(padding, line_size()) },
+			data_(detail::numa_storage(lines() * leading_dimension_, value_type{}, typename storage_type::allocator_type{ allocator }))
+		{
+
+		}
+
+		explicit DMatrix(const size_type row_count, const size_type column_count, uninitialized_t, const allocator_type& allocator = allocator_type{}) :
+			rows_{ row_count },
+			columns_{ column_count },
+			leading_dimension_{ line_size() },
+			data_(detail::numa_storage<value_type>(rows_ * columns_, uninitialized, typename storage_type::allocator_type{ allocator }))
+		{
+
+		}
+
+		explicit DMatrix(const size_type row_count, const size_type column_count, uninitialized_t, const Padding& padding, const allocator_type& allocator = allocator_type{}) :
+			rows_{ row_count },
+			columns_{ column_count },
+			leading_dimension_{ detail::resolve_padding<value_type>(padding, line_size()) },
+			data_(detail::numa_storage<value_type>(lines() * leading_dimension_, uninitialized, typename storage_type::allocator_type{ allocator }))
+		{
+
+		}
+
+		explicit DMatrix(const size_type row_count, const size_type column_count, const value_type& initial_value, const allocator_type& allocator = allocator_type{}) :
 			rows_{ row_count },
 			columns_{ column_count }, 
-			data_(rows_ * columns_, initial_value)
+			leading_dimension_{ line_size() },
+			data_(detail::numa_storage(rows_ * columns_, initial_value, typename storage_type::allocator_type{ allocator }))
 		{
 
 		}
 
-		explicit DMatrix(const size_type row_count, const size_type column_count, const std::vector<value_type>& arr) :
+		explicit DMatrix(const size_type row_count, const size_type column_count, const std::vector<value_type>& arr, const allocator_type& allocator = allocator_type{}) :
 			rows_{ row_count },
-			columns_{ column_count }
+			columns_{ column_count },
+			leading_dimension_{ line_size() },
+			data_(allocator)
 		{
 			const size_type size = rows() * columns();
 			if(arr.size() != size)
@@ -62,12 +120,14 @@ namespace PrimMatrix
 				throw Matrix_InvalidInitializerSize{ arr.size(), size };
 			}
 
-			data_ = arr;
+			data_.assign(arr.begin(), arr.end());
 		}
 
-		explicit DMatrix(const size_type row_count, const size_type column_count, std::initializer_list<value_type> il) : 
+		explicit DMatrix(const size_type row_count, const size_type column_count, std::initializer_list<value_type> il, const allocator_type& allocator = allocator_type{}) : 
 			rows_{ row_count },
-			columns_{ column_count }
+			columns_{ column_count },
+			leading_dimension_{ line_size() },
+			data_(allocator)
 		{
 			const size_type size = rows() * columns();
 			if (il.size() != size)
@@ -78,11 +138,23 @@ namespace PrimMatrix
 			data_ = std::move(il);
 		}
 
-		explicit DMatrix(const std::vector<value_type>& arr, const EOrientation orientation) :
+		explicit DMatrix(const std::vector<value_type>& arr, const EOrientation orientation, const allocator_type& allocator = allocator_type{}) :
 			rows_{ orientation == EOrientation::vertical ? arr.size() : 1 },
 			columns_{ orientation == EOrientation::horizontal ? arr.size() : 1 },
-			data_{ arr }
+			leading_dimension_{ line_size() },
+			data_(arr.begin(), arr.end(), allocator)
+		{
+		}
+
+		// Evaluates an element-wise expression in a single pass, the storage is not zeroed first
+		template <class Expression>
+		DMatrix(const MatrixExpression<Expression>& expression, const allocator_type& allocator = allocator_type{}) :
+			rows_{ expression.derived().rows() },
+			columns_{ expression.derived().columns() },
+			leading_dimension_{ line_size() },
+			data_(detail::numa_storage<value_type>(rows_ * columns_, uninitialized, typename storage_type::allocator_type{ allocator }))
 		{
+			assign_expression(expression.derived());
 		}
 
 		virtual ~DMatrix() = default;
@@ -91,16 +163,57 @@ namespace PrimMatrix
 		DMatrix(DMatrix&& rhs) noexcept :
 			rows_{ rhs.rows_ },
 			columns_{ rhs.columns_ },
+			leading_dimension_{ rhs.leading_dimension_ },
 			data_{ std::move(rhs.data_) }
 		{
-			rhs.rows_ = rhs.columns_ = 0;
+			rhs.rows_ = rhs.columns_ = rhs.leading_dimension_ = 0;
 		}
 
 		/* COPY / MOVE OPERATIONS */
 		DMatrix& operator=(const DMatrix&) = default;
-		DMatrix& operator=(DMatrix&& rhs) noexcept
+
+		// Storage is exchanged with rhs when the allocator moves along or both allocators are equal. Otherwise this
+		// matrix keeps its allocator, e.g. a heap matrix assigned from an arena one, and the elements are moved over
+		DMatrix& operator=(DMatrix&& rhs) noexcept(std::is_nothrow_move_assignable<storage_type>::value)
 		{
-			swap(*this, rhs);
+			if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
+				get_allocator() == rhs.get_allocator())
+			{
+				swap(*this, rhs);
+				return *this;
+			}
+
+			data_ = std::move(rhs.data_);
+			rows_ = rhs.rows_;
+			columns_ = rhs.columns_;
+			leading_dimension_ = rhs.leading_dimension_;
+
+			rhs.data_.clear();
+			rhs.rows_ = rhs.columns_ = rhs.leading_dimension_ = 0;
+			return *this;
+		}
+
+		// The storage is reused when the size matches and every operand reads this matrix, if at all, at the element
+		// being written; operands like t() or shifted views of it are evaluated into fresh storage first
+		template <class Expression>
+		DMatrix& operator=(const MatrixExpression<Expression>& expression)
+		{
+			if (rows() != expression.derived().rows() ||
+				columns() != expression.derived().columns())
+			{
+				*this = DMatrix{ expression, get_allocator() };
+				return *this;
+			}
+
+			if (detail::expression_aliases(ConstMatrixView<value_type, Order>{ view() }, expression.derived()))
+			{
+				DMatrix result = make_result(rows(), columns());
+				result.assign_expression(expression.derived());
+				swap(*this, result);
+				return *this;
+			}
+
+			assign_expression(expression.derived());
 			return *this;
 		}
 			
@@ -110,14 +223,20 @@ namespace PrimMatrix
 
 			swap(lhs.rows_, rhs.rows_);
 			swap(lhs.columns_, rhs.columns_);
+			swap(lhs.leading_dimension_, rhs.leading_dimension_);
 			swap(lhs.data_, rhs.data_);
 		}
 
 		/* ACCESSORS */
+		allocator_type get_allocator() const { return data_.get_allocator(); }
+
 		size_type rows() const noexcept { return rows_; }
 		size_type columns() const noexcept { return columns_; }
-		size_type size() const noexcept { return data_.size(); }
+		size_type size() const noexcept { return rows_ * columns_; }
+		size_type leading_dimension() const noexcept { return leading_dimension_; }
+		bool padded() const noexcept { return leading_dimension_ != line_size(); }
 
+		// Line l starts at data() + l * leading_dimension()
 		pointer data() noexcept { return data_.data(); }
 		const_pointer data() const noexcept { return data_.data(); }
 
@@ -128,7 +247,7 @@ namespace PrimMatrix
 				throw Matrix_IndexOutOfBounds{ index, size() };
 			}
 
-			return data_[index];
+			return data_[storage_index(index)];
 		}
 
 		const_reference at(const size_type index) const
@@ -138,7 +257,7 @@ namespace PrimMatrix
 				throw Matrix_IndexOutOfBounds{ index, size() };
 			}
 
-			return data_[index];
+			return data_[storage_index(index)];
 		}
 
 		reference at(const size_type row, const size_type column)
@@ -165,7 +284,7 @@ namespace PrimMatrix
 
 		iterator begin() noexcept
 		{
-			return data_.begin();
+			return detail::strided_begin(data(), lines(), line_size(), leading_dimension_);
 		}
 
 		const_iterator begin() const noexcept
@@ -175,7 +294,7 @@ namespace PrimMatrix
 
 		iterator end() noexcept
 		{
-			return data_.end();
+			return detail::strided_end(data(), lines(), line_size(), leading_dimension_);
 		}
 
 		const_iterator end() const noexcept
@@ -185,23 +304,23 @@ namespace PrimMatrix
 
 		const_iterator cbegin() const noexcept
 		{
-			return data_.cbegin();
+			return detail::strided_begin(data(), lines(), line_size(), leading_dimension_);
 		}
 
 		const_iterator cend() const noexcept
 		{
-			return data_.cend();
+			return detail::strided_end(data(), lines(), line_size(), leading_dimension_);
 		}
 
 		/* OPERATORS */
 		reference operator[](const size_type index)
 		{
-			return data_[index];
+			return data_[storage_index(index)];
 		}
 
 		const_reference operator[](const size_type index) const
 		{
-			return data_[index];
+			return data_[storage_index(index)];
 		}
 
 		reference operator()(const size_type row, const size_type column)
@@ -215,6 +334,18 @@ namespace PrimMatrix
 		}
 
 		DMatrix& operator+=(const DMatrix& rhs)
+		{
+			return add(execution::seq, rhs);
+		}
+
+		DMatrix& operator-=(const DMatrix& rhs)
+		{
+			return subtract(execution::seq, rhs);
+		}
+
+		// +=, -= and *= under an execution policy; execution::par and par_unseq split large matrices over the ThreadPool
+		template <class Policy, class = detail::enable_if_execution_policy<Policy>>
+		DMatrix& add(const Policy& policy, const DMatrix& rhs)
 		{
 			if (rows() != rhs.rows() ||
 				columns() != rhs.columns())
@@ -228,16 +359,13 @@ namespace PrimMatrix
 			}
 
 
-			auto rhs_it = rhs.begin();
-			for (auto& el : *this)
-			{
-				el += *rhs_it++;
-			}
+			apply_kernel(policy, detail::selected_elementwise_kernels<value_type>().add, *this, rhs, value_type{});
 
 			return *this;
 		}
 
-		DMatrix& operator-=(const DMatrix& rhs)
+		template <class Policy, class = detail::enable_if_execution_policy<Policy>>
+		DMatrix& subtract(const Policy& policy, const DMatrix& rhs)
 		{
 			if (rows() != rhs.rows() ||
 				columns() != rhs.columns())
@@ -251,52 +379,157 @@ namespace PrimMatrix
 			}
 
 
-			auto rhs_it = rhs.begin();
-			for (auto& el : *this)
-			{
-				el -= *rhs_it++;
-			}
+			apply_kernel(policy, detail::selected_elementwise_kernels<value_type>().subtract, *this, rhs, value_type{});
 
 			return *this;
 		}
 
-		DMatrix& operator*=(const DMatrix& rhs)
+		template <class Policy, class = detail::enable_if_execution_policy<Policy>>
+		DMatrix& scale(const Policy& policy, const value_type& rhs)
 		{
-			*this = *this * rhs;
+			apply_kernel(policy, detail::selected_elementwise_kernels<value_type>().scale, *this, *this, rhs);
 
 			return *this;
 		}
 
-		DMatrix& operator*=(const T& rhs)
+		template <class Expression>
+		DMatrix& operator+=(const MatrixExpression<Expression>& rhs)
+		{
+			*this = *this + rhs;
+
+			return *this;
+		}
+
+		template <class Expression>
+		DMatrix& operator-=(const MatrixExpression<Expression>& rhs)
+		{
+			*this = *this - rhs;
+
+			return *this;
+		}
+
+		// Small products go into a per-thread scratch buffer that is swapped with the storage, the old storage becomes
+		// the scratch for the next call. Large ones get storage placed like any new matrix and the old one is freed
+		DMatrix& operator*=(const DMatrix& rhs)
 		{
-			for (auto& el : *this)
+			if (columns() != rhs.rows())
 			{
-				el *= rhs;
+				throw Matrix_OperationMatrixMismatch {
+					Matrix_OperationMatrixMismatch::EOperation::multiplication,
+					rows(),
+					columns(),
+					rhs.rows(),
+					rhs.columns() };
+			}
+
+			const size_type result_line_size = Order::line_size(rows(), rhs.columns());
+			const size_type result_leading_dimension = padded() ? padded_leading_dimension<value_type>(result_line_size) : result_line_size;
+			const size_type result_lines = Order::lines(rows(), rhs.columns());
+			const size_type result_size = result_lines * result_leading_dimension;
+
+			// Stateful allocators could not trade buffers with a shared scratch
+			const bool cached = std::is_empty<allocator_type>::value && result_size * sizeof(value_type) <= detail::multiplication_scratch_bytes;
+
+			storage_type result(get_allocator());
+			if (cached)
+			{
+				result.swap(multiplication_scratch());
+				result.resize(result_size);
+			}
+			else
+			{
+				result = detail::numa_storage<value_type>(result_size, uninitialized, typename storage_type::allocator_type{ get_allocator() });
+			}
+
+			detail::gemm(
+				rows(), rhs.columns(), columns(),
+				data(), Order::row_stride(leading_dimension()), Order::column_stride(leading_dimension()),
+				rhs.data(), Order::row_stride(rhs.leading_dimension()), Order::column_stride(rhs.leading_dimension()),
+				result.data(), Order::row_stride(result_leading_dimension), Order::column_stride(result_leading_dimension));
+
+			// The padding is not written by the product, it is kept zeroed like in the other padded matrices
+			for (size_type line = 0; line < result_lines && result_leading_dimension != result_line_size; ++line)
+			{
+				std::fill(result.data() + line * result_leading_dimension + result_line_size, result.data() + (line + 1) * result_leading_dimension, value_type{});
+			}
+
+			data_.swap(result);
+			columns_ = rhs.columns();
+			leading_dimension_ = result_leading_dimension;
+
+			if (std::is_empty<allocator_type>::value && result.capacity() * sizeof(value_type) <= detail::multiplication_scratch_bytes)
+			{
+				multiplication_scratch().swap(result);
 			}
 
 			return *this;
 		}
 
+		DMatrix& operator*=(const T& rhs)
+		{
+			return scale(execution::seq, rhs);
+		}
+
 		/* OPERATIONS */
-		DMatrix transpose() const
+		DMatrix transpose() const &
+		{
+			DMatrix result_matrix = make_result(columns_, rows_);
+			detail::transpose(lines(), line_size(), data(), leading_dimension_, result_matrix.data(), result_matrix.leading_dimension());
+
+			return result_matrix;
+		}
+
+		// Square matrices are transposed in place and keep their storage
+		DMatrix transpose() &&
+		{
+			if (rows() != columns())
+			{
+				return static_cast<const DMatrix&>(*this).transpose();
+			}
+
+			transpose_in_place();
+			return std::move(*this);
+		}
+
+		// Transposes without a second matrix: square matrices swap tiles across the diagonal, rectangular ones
+		// follow the permutation cycles of the storage with one bit of bookkeeping per element. A padded
+		// rectangular matrix is packed first and padded again afterwards if the new lines fit in its storage
+		DMatrix& transpose_in_place()
 		{
-			DMatrix result_matrix{ columns_, rows_ };
+			if (rows() == columns())
+			{
+				detail::transpose_square_in_place(lines(), data(), leading_dimension_);
+				return *this;
+			}
 
-			auto current_matrix_iterator = data_.begin();
-			for (size_type result_column = 0; result_column < result_matrix.columns(); ++result_column)
+			const bool was_padded = padded();
+			for (size_type line = 1; was_padded && line < lines(); ++line)
 			{
-				for (size_type result_row = 0; result_row < result_matrix.rows(); ++result_row, ++current_matrix_iterator)
+				std::move(data() + line * leading_dimension_, data() + line * leading_dimension_ + line_size(), data() + line * line_size());
+			}
+
+			detail::transpose_cycles(lines(), line_size(), data());
+			std::swap(rows_, columns_);
+			leading_dimension_ = line_size();
+
+			const size_type padded_dimension = padded_leading_dimension<value_type>(line_size());
+			if (was_padded && lines() * padded_dimension <= data_.size())
+			{
+				for (size_type line = lines(); line-- > 1;)
 				{
-					result_matrix(result_row, result_column) = *current_matrix_iterator;
+					std::move_backward(data() + line * line_size(), data() + (line + 1) * line_size(), data() + line * padded_dimension + line_size());
 				}
+
+				leading_dimension_ = padded_dimension;
 			}
 
-			return result_matrix;
+			data_.resize(lines() * leading_dimension_);
+			return *this;
 		}
 
-		static DMatrix create_identity_matrix(const size_type size, const value_type& value = 1)
+		static DMatrix create_identity_matrix(const size_type size, const value_type& value = 1, const allocator_type& allocator = allocator_type{})
 		{
-			DMatrix identity_matrix{ size, size };
+			DMatrix identity_matrix{ size, size, allocator };
 			
 			for (size_type i = 0; i < size; ++i)
 			{
@@ -306,40 +539,136 @@ namespace PrimMatrix
 			return identity_matrix;
 		}
 
+		// Copies the block, use view() for a window that shares the storage
 		DMatrix splice(const Splice& splice) const
 		{
+			return DMatrix{ view(splice), get_allocator() };
+		}
+
+		// Views stay valid until the matrix is resized, moved from or destroyed
+		MatrixView<value_type, Order> view() noexcept
+		{
+			return MatrixView<value_type, Order>{ data(), rows(), columns(), leading_dimension() };
+		}
+
+		ConstMatrixView<value_type, Order> view() const noexcept
+		{
+			return ConstMatrixView<value_type, Order>{ data(), rows(), columns(), leading_dimension() };
+		}
+
+		MatrixView<value_type, Order> view(const Splice& splice)
+		{
+			return view().view(splice);
+		}
+
+		ConstMatrixView<value_type, Order> view(const Splice& splice) const
+		{
+			return view().view(splice);
+		}
+
+		// O(1) transpose: a view of the same storage in the other order. Products read it in place,
+		// the engine packs it like any other strided operand, so A.t() * B never copies A
+		MatrixView<value_type, typename Order::transposed> t() noexcept
+		{
+			return view().t();
+		}
+
+		ConstMatrixView<value_type, typename Order::transposed> t() const noexcept
+		{
+			return view().t();
+		}
+
+		operator ConstMatrixView<value_type, Order>() const noexcept
+		{
+			return view();
+		}
 
-			if (splice.row_begin + splice.row_count > rows() ||
-				splice.column_begin + splice.column_count > columns())
+	private:
+		static storage_type& multiplication_scratch()
+		{
+			thread_local storage_type scratch;
+			return scratch;
+		}
+
+		template <class Expression>
+		void assign_expression(const Expression& expression)
+		{
+			detail::for_each_index<Order>(rows(), columns(), [&](const size_type row, const size_type column)
 			{
-				throw Matrix_SpliceOutOfBounds{ splice, rows(), columns() };
-			}
+				data_[to_index(row, column)] = expression(row, column);
+			});
+		}
+
+		// Single operations on whole matrices go straight to the SIMD kernels
+		void assign_expression(const MatrixBinaryExpression<DMatrix, DMatrix, detail::AddOperation>& expression)
+		{
+			apply_kernel(execution::seq, detail::selected_elementwise_kernels<value_type>().add, expression.lhs(), expression.rhs(), value_type{});
+		}
+
+		void assign_expression(const MatrixBinaryExpression<DMatrix, DMatrix, detail::SubtractOperation>& expression)
+		{
+			apply_kernel(execution::seq, detail::selected_elementwise_kernels<value_type>().subtract, expression.lhs(), expression.rhs(), value_type{});
+		}
+
+		void assign_expression(const MatrixScalarExpression<DMatrix, detail::ScaleRightOperation>& expression)
+		{
+			apply_kernel(execution::seq, detail::selected_elementwise_kernels<value_type>().scale, expression.expression(), expression.expression(), expression.scalar());
+		}
+
+		// Runs an element-wise kernel line by line, or over the whole storage at once when no operand is padded
+		template <class Policy>
+		void apply_kernel(const Policy& policy, const detail::elementwise_kernel<value_type> kernel, const DMatrix& lhs, const DMatrix& rhs, const value_type& scalar)
+		{
+			detail::elementwise(
+				policy, kernel,
+				lines(), line_size(),
+				lhs.data(), lhs.leading_dimension(),
+				rhs.data(), rhs.leading_dimension(),
+				scalar,
+				data(), leading_dimension());
+		}
 
-			DMatrix<value_type> result_matrix{splice.row_count, splice.column_count};
-			for (size_type result_column = 0; result_column < result_matrix.columns(); ++result_column)
+		// Results of a padded matrix are padded as well
+		DMatrix make_result(const size_type row_count, const size_type column_count) const
+		{
+			if (padded())
 			{
-				for (size_type result_row = 0; result_row < result_matrix.rows(); ++result_row)
-				{
-					result_matrix(result_row, result_column) = data_[to_index(splice.row_begin + result_row, splice.column_begin + result_column)];
-				}
+				return DMatrix{ row_count, column_count, uninitialized, Padding{}, get_allocator() };
 			}
 
-			return result_matrix;
+			return DMatrix{ row_count, column_count, uninitialized, get_allocator() };
 		}
 
-	private:
+		size_type lines() const noexcept { return Order::lines(rows_, columns_); }
+		size_type line_size() const noexcept { return Order::line_size(rows_, columns_); }
+
 		size_type to_index(const size_type row, const size_type column) const noexcept
 		{
-			return row * columns() + column;
+			return Order::offset(row, column, leading_dimension_);
 		}
 
-		size_type rows_, columns_;
-		std::vector<value_type> data_;
+		// Element indices count in storage order and skip the padding
+		size_type storage_index(const size_type index) const noexcept
+		{
+			if (!padded())
+			{
+				return index;
+			}
+
+			return index / line_size() * leading_dimension_ + index % line_size();
+		}
+
+		size_type rows_, columns_, leading_dimension_;
+		storage_type data_;
 
 	};
 
-	template <class T>
-	bool operator==(const DMatrix<T>& lhs, const DMatrix<T> rhs)
+	// Matrices living in a MatrixArena, allocated from the thread's current ArenaScope
+	template <class T, class Order = RowMajor>
+	using ArenaDMatrix = DMatrix<T, ArenaAllocator<T>, Order>;
+
+	template <class T, class LhsAlloc, class LhsOrder, class RhsAlloc, class RhsOrder>
+	bool operator==(const DMatrix<T, LhsAlloc, LhsOrder>& lhs, const DMatrix<T, RhsAlloc, RhsOrder>& rhs)
 	{
 		if (lhs.rows() != rhs.rows() ||
 			lhs.columns() != rhs.columns())
@@ -347,6 +676,23 @@ namespace PrimMatrix
 			return false;
 		}
 
+		// Storage can only be compared directly when both matrices lay it out the same way
+		if (!std::is_same<LhsOrder, RhsOrder>::value)
+		{
+			for (size_t row = 0; row < lhs.rows(); ++row)
+			{
+				for (size_t column = 0; column < lhs.columns(); ++column)
+				{
+					if (lhs(row, column) != rhs(row, column))
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
 		auto lhs_it = lhs.begin();
 		for (const auto& rhs_el : rhs)
 		{
@@ -359,113 +705,450 @@ namespace PrimMatrix
 		return true;
 	}
 
-	template<class T>
-	bool operator!=(const DMatrix<T>& lhs, const DMatrix<T> rhs)
+	template <class T, class LhsAlloc, class LhsOrder, class RhsAlloc, class RhsOrder>
+	bool operator!=(const DMatrix<T, LhsAlloc, LhsOrder>& lhs, const DMatrix<T, RhsAlloc, RhsOrder>& rhs)
 	{
 		return !(lhs == rhs);
 	}
 
-	template <class T>
-	DMatrix<T> operator+(const DMatrix<T>& lhs, const DMatrix<T>& rhs)
+	// Overloads for expiring matrices, the result is computed into the temporary's storage
+	template <class T, class Alloc, class Order, class Rhs>
+	DMatrix<T, Alloc, Order> operator+(DMatrix<T, Alloc, Order>&& lhs, const MatrixExpression<Rhs>& rhs)
 	{
-		if (lhs.rows() != rhs.rows() ||
-			lhs.columns() != rhs.columns())
+		lhs += rhs;
+		return std::move(lhs);
+	}
+
+	template <class Lhs, class T, class Alloc, class Order>
+	DMatrix<T, Alloc, Order> operator+(const MatrixExpression<Lhs>& lhs, DMatrix<T, Alloc, Order>&& rhs)
+	{
+		rhs = lhs + rhs;
+		return std::move(rhs);
+	}
+
+	template <class T, class Alloc, class Order>
+	DMatrix<T, Alloc, Order> operator+(DMatrix<T, Alloc, Order>&& lhs, DMatrix<T, Alloc, Order>&& rhs)
+	{
+		lhs += rhs;
+		return std::move(lhs);
+	}
+
+	template <class T, class Alloc, class Order, class Rhs>
+	DMatrix<T, Alloc, Order> operator-(DMatrix<T, Alloc, Order>&& lhs, const MatrixExpression<Rhs>& rhs)
+	{
+		lhs -= rhs;
+		return std::move(lhs);
+	}
+
+	template <class Lhs, class T, class Alloc, class Order>
+	DMatrix<T, Alloc, Order> operator-(const MatrixExpression<Lhs>& lhs, DMatrix<T, Alloc, Order>&& rhs)
+	{
+		rhs = lhs - rhs;
+		return std::move(rhs);
+	}
+
+	template <class T, class Alloc, class Order>
+	DMatrix<T, Alloc, Order> operator-(DMatrix<T, Alloc, Order>&& lhs, DMatrix<T, Alloc, Order>&& rhs)
+	{
+		lhs -= rhs;
+		return std::move(lhs);
+	}
+
+	template <class T, class Alloc, class Order>
+	DMatrix<T, Alloc, Order> operator*(DMatrix<T, Alloc, Order>&& lhs, const typename DMatrix<T, Alloc, Order>::value_type& rhs)
+	{
+		lhs *= rhs;
+		return std::move(lhs);
+	}
+
+	template <class T, class Alloc, class Order>
+	DMatrix<T, Alloc, Order> operator*(const typename DMatrix<T, Alloc, Order>::value_type& lhs, DMatrix<T, Alloc, Order>&& rhs)
+	{
+		rhs *= lhs;
+		return std::move(rhs);
+	}
+
+	namespace detail
+	{
+		// Matrices and views are multiplied where they are, other expressions are evaluated first
+		template <class T, class Alloc, class Order>
+		ConstMatrixView<T, Order> product_operand(const DMatrix<T, Alloc, Order>& matrix)
 		{
-			throw Matrix_OperationMatrixMismatch {
-				Matrix_OperationMatrixMismatch::EOperation::addition,
-				lhs.rows(),
-				lhs.columns(),
-				rhs.rows(),
-				rhs.columns() };
+			return matrix.view();
 		}
 
-		DMatrix<T> result_matrix(lhs.rows(), lhs.columns());
-		
-		auto lhs_it = lhs.begin();
-		auto rhs_it = rhs.begin();
-		for (auto& result_el : result_matrix)
+		template <class T, class Order>
+		ConstMatrixView<T, Order> product_operand(const ConstMatrixView<T, Order>& view)
 		{
-			result_el = *lhs_it++ + *rhs_it++;
+			return view;
 		}
 
-		return result_matrix;
-	}
+		template <class T, class Order>
+		ConstMatrixView<T, Order> product_operand(const MatrixView<T, Order>& view)
+		{
+			return view;
+		}
 
-	template <class T>
-	DMatrix<T> operator-(const DMatrix<T>& lhs, const DMatrix<T>& rhs)
-	{
-		if (lhs.rows() != rhs.rows() ||
-			lhs.columns() != rhs.columns())
+		template <class Expression>
+		DMatrix<typename Expression::value_type> product_operand(const MatrixExpression<Expression>& expression)
 		{
-			throw Matrix_OperationMatrixMismatch {
-				Matrix_OperationMatrixMismatch::EOperation::subtraction,
-				lhs.rows(),
-				lhs.columns(),
-				rhs.rows(),
-				rhs.columns() };
+			return DMatrix<typename Expression::value_type>{ expression };
 		}
 
-		DMatrix<T> result_matrix(lhs.rows(), lhs.columns());
+		template <class Lhs, class Rhs>
+		void check_product(const Lhs& lhs, const Rhs& rhs)
+		{
+			if (lhs.columns() != rhs.rows())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					Matrix_OperationMatrixMismatch::EOperation::multiplication,
+					lhs.rows(),
+					lhs.columns(),
+					rhs.rows(),
+					rhs.columns() };
+			}
+		}
 
-		auto lhs_it = lhs.begin();
-		auto rhs_it = rhs.begin();
-		for (auto& result_el : result_matrix)
+		// Layouts are handed to the engine as strides, so mixed storage orders multiply without conversions
+		template <class T, class LhsOrder, class RhsOrder, class ResultOrder, class Epilogue>
+		void gemm(
+			const T& alpha,
+			const ConstMatrixView<T, LhsOrder>& lhs,
+			const ConstMatrixView<T, RhsOrder>& rhs,
+			const T& beta,
+			MatrixView<T, ResultOrder> result,
+			const Epilogue& epilogue)
 		{
-			result_el = *lhs_it++ - *rhs_it++;
+			check_product(lhs, rhs);
+
+			if (result.rows() != lhs.rows() ||
+				result.columns() != rhs.columns())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					Matrix_OperationMatrixMismatch::EOperation::addition,
+					result.rows(),
+					result.columns(),
+					lhs.rows(),
+					rhs.columns() };
+			}
+
+			validate_epilogue(epilogue, result.rows(), result.columns());
+
+			// The engine overwrites result while still reading the operands
+			const ConstMatrixView<T, ResultOrder> result_view = result;
+			if (views_overlap(result_view, lhs) ||
+				views_overlap(result_view, rhs))
+			{
+				DMatrix<T, std::allocator<T>, ResultOrder> aliased_result{ result };
+				gemm(alpha, lhs, rhs, beta, aliased_result.view(), epilogue);
+				result = aliased_result;
+
+				return;
+			}
+
+			gemm(
+				result.rows(), result.columns(), lhs.columns(),
+				alpha,
+				lhs.data(), LhsOrder::row_stride(lhs.leading_dimension()), LhsOrder::column_stride(lhs.leading_dimension()),
+				rhs.data(), RhsOrder::row_stride(rhs.leading_dimension()), RhsOrder::column_stride(rhs.leading_dimension()),
+				beta,
+				result.data(), ResultOrder::row_stride(result.leading_dimension()), ResultOrder::column_stride(result.leading_dimension()),
+				epilogue);
 		}
+	}
+
+	template <class T, class LhsAlloc, class LhsOrder, class RhsAlloc, class RhsOrder>
+	DMatrix<T, LhsAlloc, LhsOrder> operator*(const DMatrix<T, LhsAlloc, LhsOrder>& lhs, const DMatrix<T, RhsAlloc, RhsOrder>& rhs)
+	{
+		detail::check_product(lhs, rhs);
+
+		DMatrix<T, LhsAlloc, LhsOrder> result_matrix = lhs.padded() ?
+			DMatrix<T, LhsAlloc, LhsOrder>{ lhs.rows(), rhs.columns(), uninitialized, Padding{}, lhs.get_allocator() } :
+			DMatrix<T, LhsAlloc, LhsOrder>{ lhs.rows(), rhs.columns(), uninitialized, lhs.get_allocator() };
+		detail::gemm(T{ 1 }, lhs.view(), rhs.view(), T{}, result_matrix.view(), NoEpilogue{});
 
 		return result_matrix;
 	}
 
-	template <class T>
-	DMatrix<T> operator*(const DMatrix<T>& lhs, const DMatrix<T>& rhs)
+	namespace detail
 	{
-		using size_type = typename DMatrix<T>::size_type;
+		// Same size and padding as the operand, for results every element of which is written
+		template <class T, class Alloc, class Order>
+		DMatrix<T, Alloc, Order> elementwise_result(const DMatrix<T, Alloc, Order>& operand)
+		{
+			return DMatrix<T, Alloc, Order>{ operand.rows(), operand.columns(), uninitialized, Padding{ operand.leading_dimension() }, operand.get_allocator() };
+		}
 
-		if (lhs.columns() != rhs.rows())
+		template <class Policy, class T, class Alloc, class Order>
+		DMatrix<T, Alloc, Order> elementwise(
+			const Policy& policy,
+			const elementwise_kernel<T> kernel,
+			const Matrix_OperationMatrixMismatch::EOperation operation,
+			const DMatrix<T, Alloc, Order>& lhs,
+			const DMatrix<T, Alloc, Order>& rhs,
+			const T& scalar)
 		{
-			throw Matrix_OperationMatrixMismatch { 
-				Matrix_OperationMatrixMismatch::EOperation::multiplication, 
-				lhs.rows(), 
-				lhs.columns(), 
-				rhs.rows(), 
-				rhs.columns() };
+			if (lhs.rows() != rhs.rows() ||
+				lhs.columns() != rhs.columns())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					operation,
+					lhs.rows(),
+					lhs.columns(),
+					rhs.rows(),
+					rhs.columns() };
+			}
+
+			DMatrix<T, Alloc, Order> result_matrix = elementwise_result(lhs);
+			elementwise(
+				policy, kernel,
+				Order::lines(lhs.rows(), lhs.columns()), Order::line_size(lhs.rows(), lhs.columns()),
+				lhs.data(), lhs.leading_dimension(),
+				rhs.data(), rhs.leading_dimension(),
+				scalar,
+				result_matrix.data(), result_matrix.leading_dimension());
+
+			return result_matrix;
 		}
+	}
+
+	// lhs + rhs, lhs - rhs and lhs * scalar under an execution policy, evaluated straight into a new matrix
+	template <class Policy, class T, class Alloc, class Order, class = detail::enable_if_execution_policy<Policy>>
+	DMatrix<T, Alloc, Order> add(const Policy& policy, const DMatrix<T, Alloc, Order>& lhs, const DMatrix<T, Alloc, Order>& rhs)
+	{
+		return detail::elementwise(policy, detail::selected_elementwise_kernels<T>().add, Matrix_OperationMatrixMismatch::EOperation::addition, lhs, rhs, T{});
+	}
+
+	template <class Policy, class T, class Alloc, class Order, class = detail::enable_if_execution_policy<Policy>>
+	DMatrix<T, Alloc, Order> subtract(const Policy& policy, const DMatrix<T, Alloc, Order>& lhs, const DMatrix<T, Alloc, Order>& rhs)
+	{
+		return detail::elementwise(policy, detail::selected_elementwise_kernels<T>().subtract, Matrix_OperationMatrixMismatch::EOperation::subtraction, lhs, rhs, T{});
+	}
+
+	template <class Policy, class T, class Alloc, class Order, class = detail::enable_if_execution_policy<Policy>>
+	DMatrix<T, Alloc, Order> scale(const Policy& policy, const DMatrix<T, Alloc, Order>& lhs, const typename DMatrix<T, Alloc, Order>::value_type& rhs)
+	{
+		return detail::elementwise(policy, detail::selected_elementwise_kernels<T>().scale, Matrix_OperationMatrixMismatch::EOperation::multiplication, lhs, lhs, rhs);
+	}
 
-		DMatrix<T> result_matrix{ lhs.rows(), rhs.columns() };
+	// result = epilogue(alpha * lhs * rhs + beta * result), without temporaries; result is not read when beta is zero.
+	// Matrices and views are read in place, other expressions are evaluated first
+	template <class Lhs, class Rhs, class T, class ResultAlloc, class ResultOrder, class Epilogue = NoEpilogue>
+	void gemm(
+		const typename DMatrix<T, ResultAlloc, ResultOrder>::value_type& alpha,
+		const MatrixExpression<Lhs>& lhs,
+		const MatrixExpression<Rhs>& rhs,
+		const typename DMatrix<T, ResultAlloc, ResultOrder>::value_type& beta,
+		DMatrix<T, ResultAlloc, ResultOrder>& result,
+		const Epilogue& epilogue = Epilogue{})
+	{
+		const auto& lhs_operand = detail::product_operand(lhs.derived());
+		const auto& rhs_operand = detail::product_operand(rhs.derived());
+		detail::gemm(alpha, lhs_operand.view(), rhs_operand.view(), beta, result.view(), epilogue);
+	}
+
+	// Writes through a view, e.g. into a block of a larger matrix
+	template <class Lhs, class Rhs, class T, class ResultOrder, class Epilogue = NoEpilogue>
+	void gemm(
+		const typename MatrixView<T, ResultOrder>::value_type& alpha,
+		const MatrixExpression<Lhs>& lhs,
+		const MatrixExpression<Rhs>& rhs,
+		const typename MatrixView<T, ResultOrder>::value_type& beta,
+		const MatrixView<T, ResultOrder>& result,
+		const Epilogue& epilogue = Epilogue{})
+	{
+		const auto& lhs_operand = detail::product_operand(lhs.derived());
+		const auto& rhs_operand = detail::product_operand(rhs.derived());
+		detail::gemm(alpha, lhs_operand.view(), rhs_operand.view(), beta, result, epilogue);
+	}
 
-		const auto sum_len = lhs.columns();
-		for (size_type result_row = 0; result_row < result_matrix.rows(); ++result_row)
+	namespace detail
+	{
+		template <class T, class Order, class ResultOrder>
+		void syrk(
+			const T& alpha,
+			const ConstMatrixView<T, Order>& a,
+			const T& beta,
+			MatrixView<T, ResultOrder> result,
+			const ETriangle triangle,
+			const ESymmetricFill fill)
 		{
-			for (size_type result_column = 0; result_column < result_matrix.columns(); ++result_column)
+			if (result.rows() != a.rows() ||
+				result.columns() != a.rows())
 			{
-				for (size_type sum_index = 0; sum_index < sum_len; ++sum_index)
-				{
-					result_matrix(result_row, result_column) += lhs(result_row, sum_index) * rhs(sum_index, result_column);
-				}
+				throw Matrix_OperationMatrixMismatch {
+					Matrix_OperationMatrixMismatch::EOperation::addition,
+					result.rows(),
+					result.columns(),
+					a.rows(),
+					a.rows() };
+			}
+
+			const ConstMatrixView<T, ResultOrder> result_view = result;
+			if (views_overlap(result_view, a))
+			{
+				DMatrix<T, std::allocator<T>, ResultOrder> aliased_result{ result };
+				syrk(alpha, a, beta, aliased_result.view(), triangle, fill);
+				result = aliased_result;
+
+				return;
 			}
+
+			syrk(
+				a.rows(), a.columns(),
+				alpha,
+				a.data(), Order::row_stride(a.leading_dimension()), Order::column_stride(a.leading_dimension()),
+				beta,
+				result.data(), ResultOrder::row_stride(result.leading_dimension()), ResultOrder::column_stride(result.leading_dimension()),
+				triangle,
+				fill == ESymmetricFill::full);
 		}
 
+		template <class T, class SymmetricOrder, class RhsOrder, class ResultOrder>
+		void symm(
+			const T& alpha,
+			const ConstMatrixView<T, SymmetricOrder>& symmetric,
+			const ETriangle triangle,
+			const ConstMatrixView<T, RhsOrder>& rhs,
+			const T& beta,
+			MatrixView<T, ResultOrder> result)
+		{
+			// A symmetric operand has to be square, i.e. multipliable by itself
+			check_product(symmetric, symmetric);
+			check_product(symmetric, rhs);
+
+			if (result.rows() != symmetric.rows() ||
+				result.columns() != rhs.columns())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					Matrix_OperationMatrixMismatch::EOperation::addition,
+					result.rows(),
+					result.columns(),
+					symmetric.rows(),
+					rhs.columns() };
+			}
+
+			const ConstMatrixView<T, ResultOrder> result_view = result;
+			if (views_overlap(result_view, symmetric) ||
+				views_overlap(result_view, rhs))
+			{
+				DMatrix<T, std::allocator<T>, ResultOrder> aliased_result{ result };
+				symm(alpha, symmetric, triangle, rhs, beta, aliased_result.view());
+				result = aliased_result;
+
+				return;
+			}
+
+			symm(
+				rhs.rows(), rhs.columns(),
+				alpha,
+				symmetric.data(), SymmetricOrder::row_stride(symmetric.leading_dimension()), SymmetricOrder::column_stride(symmetric.leading_dimension()),
+				triangle,
+				rhs.data(), RhsOrder::row_stride(rhs.leading_dimension()), RhsOrder::column_stride(rhs.leading_dimension()),
+				beta,
+				result.data(), ResultOrder::row_stride(result.leading_dimension()), ResultOrder::column_stride(result.leading_dimension()));
+		}
+	}
+
+	// The triangle of result = alpha * a * a^T + beta * result, at about half the cost of the full product. The other
+	// triangle is left alone unless fill asks for the computed one to be mirrored; pass a.t() for a^T * a
+	template <class Expression, class T, class ResultOrder>
+	void syrk(
+		const typename MatrixView<T, ResultOrder>::value_type& alpha,
+		const MatrixExpression<Expression>& a,
+		const typename MatrixView<T, ResultOrder>::value_type& beta,
+		const MatrixView<T, ResultOrder>& result,
+		const ETriangle triangle = ETriangle::lower,
+		const ESymmetricFill fill = ESymmetricFill::triangle)
+	{
+		const auto& operand = detail::product_operand(a.derived());
+		detail::syrk(alpha, operand.view(), beta, result, triangle, fill);
+	}
+
+	template <class Expression, class T, class ResultAlloc, class ResultOrder>
+	void syrk(
+		const typename DMatrix<T, ResultAlloc, ResultOrder>::value_type& alpha,
+		const MatrixExpression<Expression>& a,
+		const typename DMatrix<T, ResultAlloc, ResultOrder>::value_type& beta,
+		DMatrix<T, ResultAlloc, ResultOrder>& result,
+		const ETriangle triangle = ETriangle::lower,
+		const ESymmetricFill fill = ESymmetricFill::triangle)
+	{
+		syrk(alpha, a, beta, result.view(), triangle, fill);
+	}
+
+	// a * a^T with both triangles filled, e.g. a covariance from centered samples laid out one per column
+	template <class Expression>
+	auto syrk(const MatrixExpression<Expression>& a)
+	{
+		using value_type = typename Expression::value_type;
+
+		const auto& operand = detail::product_operand(a.derived());
+		DMatrix<value_type> result_matrix{ operand.rows(), operand.rows(), uninitialized };
+		detail::syrk(value_type{ 1 }, operand.view(), value_type{}, result_matrix.view(), ETriangle::lower, ESymmetricFill::full);
+
 		return result_matrix;
 	}
 
-	template <class T>
-	DMatrix<T> operator*(const DMatrix<T>& lhs, const T& rhs)
+	// result = alpha * symmetric * rhs + beta * result where only the given triangle of symmetric is read,
+	// so the other one may hold anything (e.g. the output of a syrk without fill)
+	template <class Symmetric, class Rhs, class T, class ResultOrder>
+	void symm(
+		const typename MatrixView<T, ResultOrder>::value_type& alpha,
+		const MatrixExpression<Symmetric>& symmetric,
+		const ETriangle triangle,
+		const MatrixExpression<Rhs>& rhs,
+		const typename MatrixView<T, ResultOrder>::value_type& beta,
+		const MatrixView<T, ResultOrder>& result)
 	{
-		DMatrix<T> result_matrix{ lhs.rows(), lhs.columns() };
+		const auto& symmetric_operand = detail::product_operand(symmetric.derived());
+		const auto& rhs_operand = detail::product_operand(rhs.derived());
+		detail::symm(alpha, symmetric_operand.view(), triangle, rhs_operand.view(), beta, result);
+	}
 
-		auto result_it = result_matrix.begin();
-		for (const auto& lhs_value : lhs)
-		{
-			*result_it++ = lhs_value * rhs;
-		}
+	template <class Symmetric, class Rhs, class T, class ResultAlloc, class ResultOrder>
+	void symm(
+		const typename DMatrix<T, ResultAlloc, ResultOrder>::value_type& alpha,
+		const MatrixExpression<Symmetric>& symmetric,
+		const ETriangle triangle,
+		const MatrixExpression<Rhs>& rhs,
+		const typename DMatrix<T, ResultAlloc, ResultOrder>::value_type& beta,
+		DMatrix<T, ResultAlloc, ResultOrder>& result)
+	{
+		symm(alpha, symmetric, triangle, rhs, beta, result.view());
+	}
+
+	template <class Symmetric, class Rhs>
+	auto symm(const MatrixExpression<Symmetric>& symmetric, const ETriangle triangle, const MatrixExpression<Rhs>& rhs)
+	{
+		using value_type = typename Symmetric::value_type;
+
+		const auto& symmetric_operand = detail::product_operand(symmetric.derived());
+		const auto& rhs_operand = detail::product_operand(rhs.derived());
+		DMatrix<value_type> result_matrix{ symmetric_operand.rows(), rhs_operand.columns(), uninitialized };
+		detail::symm(value_type{ 1 }, symmetric_operand.view(), triangle, rhs_operand.view(), value_type{}, result_matrix.view());
 
 		return result_matrix;
 	}
 
-	template <class T>
-	DMatrix<T> operator*(const T& lhs, const DMatrix<T>& rhs)
+	// Products are not element-wise; matrices and views are read in place, other expressions are evaluated first.
+	// The result keeps the storage order both operands share and is row-major otherwise, so products with a transposed
+	// view like A.t() * A of row-major matrices stay DMatrix<T>; gemm reads the transposed operand as it is laid out
+	template <class Lhs, class Rhs>
+	auto operator*(const MatrixExpression<Lhs>& lhs, const MatrixExpression<Rhs>& rhs)
 	{
-		return rhs * lhs;
-	}	
-}
\ No newline at end of file
+		using value_type = typename Lhs::value_type;
+
+		const auto& lhs_operand = detail::product_operand(lhs.derived());
+		const auto& rhs_operand = detail::product_operand(rhs.derived());
+		detail::check_product(lhs_operand, rhs_operand);
+
+		using lhs_order = typename std::decay<decltype(lhs_operand)>::type::order_type;
+		using rhs_order = typename std::decay<decltype(rhs_operand)>::type::order_type;
+		using result_order = typename std::conditional<std::is_same<lhs_order, rhs_order>::value, lhs_order, RowMajor>::type;
+		DMatrix<value_type, std::allocator<value_type>, result_order> result_matrix{ lhs_operand.rows(), rhs_operand.columns(), uninitialized };
+		detail::gemm(value_type{ 1 }, lhs_operand.view(), rhs_operand.view(), value_type{}, result_matrix.view(), NoEpilogue{});
+
+		return result_matrix;
+	}
+}
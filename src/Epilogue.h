@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "Matrix_Exception.h"
+
+namespace PrimMatrix
+{
+	// Epilogues are called as epilogue(value, row, column) on every element of the gemm output,
+	// right after the element's final value has been computed, and return the value to store
+
+	struct NoEpilogue
+	{
+		template <class T>
+		T operator()(const T& value, size_t, size_t) const
+		{
+			return value;
+		}
+	};
+
+	// Adds bias[column] to every row of the output
+	template <class T>
+	class BiasEpilogue
+	{
+	public:
+		explicit BiasEpilogue(const T* bias, const size_t size) :
+			bias_{ bias },
+			size_{ size }
+		{
+
+		}
+
+		// Takes any matrix holding a single row or column, the bias has to outlive the gemm call
+		template <class Matrix>
+		explicit BiasEpilogue(const Matrix& bias) :
+			BiasEpilogue{ bias.data(), bias.size() }
+		{
+
+		}
+
+		T operator()(const T& value, size_t, const size_t column) const
+		{
+			return value + bias_[column];
+		}
+
+		size_t size() const noexcept { return size_; }
+
+	private:
+		const T* bias_;
+		size_t size_;
+	};
+
+	struct ReluEpilogue
+	{
+		template <class T>
+		T operator()(const T& value, size_t, size_t) const
+		{
+			return value < T{} ? T{} : value;
+		}
+	};
+
+	template <class T>
+	class ClampEpilogue
+	{
+	public:
+		explicit ClampEpilogue(const T& low, const T& high) :
+			low_{ low },
+			high_{ high }
+		{
+
+		}
+
+		T operator()(const T& value, size_t, size_t) const
+		{
+			return value < low_ ? low_ : (high_ < value ? high_ : value);
+		}
+
+	private:
+		T low_, high_;
+	};
+
+	// Applies first, then second
+	template <class First, class Second>
+	class ChainedEpilogue
+	{
+	public:
+		explicit ChainedEpilogue(First first, Second second) :
+			first_{ std::move(first) },
+			second_{ std::move(second) }
+		{
+
+		}
+
+		template <class T>
+		T operator()(const T& value, const size_t row, const size_t column) const
+		{
+			return second_(first_(value, row, column), row, column);
+		}
+
+		const First& first() const noexcept { return first_; }
+		const Second& second() const noexcept { return second_; }
+
+	private:
+		First first_;
+		Second second_;
+	};
+
+	template <class First, class Second>
+	ChainedEpilogue<First, Second> chain_epilogues(First first, Second second)
+	{
+		return ChainedEpilogue<First, Second>{ std::move(first), std::move(second) };
+	}
+
+	namespace detail
+	{
+		// Shifts the indices seen by an epilogue, used when a sub-block of the output is computed on its own
+		template <class Epilogue>
+		struct OffsetEpilogue
+		{
+			const Epilogue& epilogue;
+			size_t row_offset;
+			size_t column_offset;
+
+			template <class T>
+			T operator()(const T& value, const size_t row, const size_t column) const
+			{
+				return epilogue(value, row + row_offset, column + column_offset);
+			}
+		};
+
+		// Swaps the indices seen by an epilogue, used when the transposed product is computed instead
+		template <class Epilogue>
+		struct TransposedEpilogue
+		{
+			const Epilogue& epilogue;
+
+			template <class T>
+			T operator()(const T& value, const size_t row, const size_t column) const
+			{
+				return epilogue(value, column, row);
+			}
+		};
+
+		template <class Epilogue>
+		void validate_epilogue(const Epilogue&, size_t, size_t)
+		{
+
+		}
+
+		template <class T>
+		void validate_epilogue(const BiasEpilogue<T>& epilogue, const size_t rows, const size_t columns)
+		{
+			if (epilogue.size() != columns)
+			{
+				throw Matrix_OperationMatrixMismatch{
+					Matrix_OperationMatrixMismatch::EOperation::addition,
+					rows,
+					columns,
+					1,
+					epilogue.size() };
+			}
+		}
+
+		template <class First, class Second>
+		void validate_epilogue(const ChainedEpilogue<First, Second>& epilogue, const size_t rows, const size_t columns)
+		{
+			validate_epilogue(epilogue.first(), rows, columns);
+			validate_epilogue(epilogue.second(), rows, columns);
+		}
+	}
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Allocator.h"
+#include "Kernels.h"
+#include "Numa.h"
+#include "ThreadPool.h"
+
+namespace PrimMatrix
+{
+	// Execution policies for the operations that take one, named after std::execution. seq stays on the calling thread,
+	// par and par_unseq split large operations over the ThreadPool. The kernels are vectorized under every policy,
+	// so par_unseq runs exactly like par
+	namespace execution
+	{
+		struct sequenced_policy
+		{
+			explicit sequenced_policy() = default;
+		};
+
+		struct parallel_policy
+		{
+			explicit parallel_policy() = default;
+		};
+
+		struct parallel_unsequenced_policy
+		{
+			explicit parallel_unsequenced_policy() = default;
+		};
+
+		constexpr sequenced_policy seq{};
+		constexpr parallel_policy par{};
+		constexpr parallel_unsequenced_policy par_unseq{};
+	}
+
+	template <class T>
+	struct is_execution_policy : std::false_type {};
+
+	template <>
+	struct is_execution_policy<execution::sequenced_policy> : std::true_type {};
+
+	template <>
+	struct is_execution_policy<execution::parallel_policy> : std::true_type {};
+
+	template <>
+	struct is_execution_policy<execution::parallel_unsequenced_policy> : std::true_type {};
+
+	namespace detail
+	{
+		template <class Policy>
+		struct is_parallel_policy : std::false_type {};
+
+		template <>
+		struct is_parallel_policy<execution::parallel_policy> : std::true_type {};
+
+		template <>
+		struct is_parallel_policy<execution::parallel_unsequenced_policy> : std::true_type {};
+
+		template <class Policy>
+		using enable_if_execution_policy = typename std::enable_if<is_execution_policy<typename std::decay<Policy>::type>::value>::type;
+
+		// Element-wise operations are bandwidth bound. Below this many elements waking the pool costs more than
+		// the extra memory controllers save
+		constexpr size_t elementwise_parallel_threshold = 256 * 1024;
+
+		// Least work per task: as much of each operand as fits in half an L2, a whole number of cache lines
+		constexpr size_t elementwise_chunk_bytes = 128 * 1024;
+
+		template <class T>
+		constexpr size_t elementwise_chunk() noexcept
+		{
+			return std::max<size_t>(elementwise_chunk_bytes / sizeof(T) / (cache_line_size / sizeof(T)), 1) * (cache_line_size / sizeof(T));
+		}
+
+		// out = lhs op rhs over `lines` lines of line_size elements, each operand with its own leading dimension. Without
+		// padding the storage is one range; under a parallel policy large ranges are split on chunk boundaries, so no two
+		// tasks write the same cache line
+		template <class Policy, class T>
+		void elementwise(
+			const Policy&,
+			const elementwise_kernel<T> kernel,
+			const size_t lines, const size_t line_size,
+			const T* lhs, const size_t lhs_ld,
+			const T* rhs, const size_t rhs_ld,
+			const T& scalar,
+			T* out, const size_t out_ld)
+		{
+			const size_t size = lines * line_size;
+			const bool contiguous = lhs_ld == line_size && rhs_ld == line_size && out_ld == line_size;
+			ThreadPool& pool = ThreadPool::instance();
+
+			if (!is_parallel_policy<Policy>::value || pool.concurrency() <= 1 || size < elementwise_parallel_threshold)
+			{
+				if (contiguous)
+				{
+					kernel(size, lhs, rhs, scalar, out);
+					return;
+				}
+
+				for (size_t line = 0; line < lines; ++line)
+				{
+					kernel(line_size, lhs + line * lhs_ld, rhs + line * rhs_ld, scalar, out + line * out_ld);
+				}
+
+				return;
+			}
+
+			const size_t chunk = elementwise_chunk<T>();
+			if (contiguous)
+			{
+				pool.parallel_for(0, (size + chunk - 1) / chunk, 1, [&](const size_t chunk_begin, const size_t chunk_end)
+				{
+					const size_t begin = chunk_begin * chunk;
+					const size_t end = std::min(size, chunk_end * chunk);
+					kernel(end - begin, lhs + begin, rhs + begin, scalar, out + begin);
+				});
+
+				return;
+			}
+
+			pool.parallel_for(0, lines, std::max<size_t>(chunk / std::max<size_t>(line_size, 1), 1), [&](const size_t line_begin, const size_t line_end)
+			{
+				for (size_t line = line_begin; line < line_end; ++line)
+				{
+					kernel(line_size, lhs + line * lhs_ld, rhs + line * rhs_ld, scalar, out + line * out_ld);
+				}
+			});
+		}
+
+		// Large storage of trivial elements is placed under the NUMA policy; everything else is constructed as usual
+		template <class T>
+		bool numa_placed(const size_t size) noexcept
+		{
+			return std::is_trivial<T>::value && numa_policy() != ENumaPolicy::local && size >= elementwise_parallel_threshold;
+		}
+
+		// Writes value over [data, data + size) in the chunks parallel_for gives the pool's threads, cut on page
+		// boundaries, so each page is first touched by the thread whose share of the later parallel operations it is
+		template <class T>
+		void numa_fill(T* data, const size_t size, const T& value)
+		{
+			const size_t page_elements = std::max<size_t>(numa_page_size / sizeof(T), 1);
+			ThreadPool::instance().parallel_for(0, (size + page_elements - 1) / page_elements, 1, [&](const size_t page_begin, const size_t page_end)
+			{
+				std::fill(data + page_begin * page_elements, data + std::min(size, page_end * page_elements), value);
+			});
+		}
+
+		// Storage of size elements equal to value
+		template <class T, class Alloc>
+		std::vector<T, Alloc> numa_storage(const size_t size, const T& value, const Alloc& allocator)
+		{
+			if (!numa_placed<T>(size))
+			{
+				return std::vector<T, Alloc>(size, value, allocator);
+			}
+
+			// Alloc default-initializes, the pages stay untouched until the fill
+			std::vector<T, Alloc> storage(size, allocator);
+			if (numa_policy() == ENumaPolicy::interleave)
+			{
+				numa_interleave(storage.data(), size * sizeof(T));
+			}
+
+			numa_fill(storage.data(), size, value);
+			return storage;
+		}
+
+		// Storage of size uninitialized elements; under interleave their pages are spread before anything touches them
+		template <class T, class Alloc>
+		std::vector<T, Alloc> numa_storage(const size_t size, uninitialized_t, const Alloc& allocator)
+		{
+			std::vector<T, Alloc> storage(size, allocator);
+			if (numa_placed<T>(size) && numa_policy() == ENumaPolicy::interleave)
+			{
+				numa_interleave(storage.data(), size * sizeof(T));
+			}
+
+			return storage;
+		}
+	}
+}
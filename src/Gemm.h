@@ -0,0 +1,600 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Epilogue.h"
+#include "Kernels.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+
+namespace PrimMatrix
+{
+	namespace detail
+	{
+		// Rough cache sizes used to derive the blocking, the engine only needs them to be in the right ballpark
+		constexpr size_t cache_l1_size = 32 * 1024;
+		constexpr size_t cache_l2_size = 256 * 1024;
+		constexpr size_t cache_l3_size = 8 * 1024 * 1024;
+
+		// Products with fewer multiply-adds than this stay on the simple loop, packing is not worth it there
+		constexpr size_t gemm_threshold = 32 * 32 * 32;
+
+		// Below this many multiply-adds waking the pool costs more than it saves
+		constexpr size_t gemm_parallel_threshold = 128 * 128 * 128;
+
+		// Output tiles are not split below this many rows / columns
+		constexpr size_t gemm_min_tile_size = 64;
+
+		struct GemmBlocking
+		{
+			size_t mc;
+			size_t kc;
+			size_t nc;
+		};
+
+		template <class T>
+		GemmBlocking gemm_blocking(const size_t mr, const size_t nr)
+		{
+			// A and B micro-panels share half of L1, an A block takes half of L2, a B block half of L3
+			const size_t kc = std::max<size_t>(cache_l1_size / 2 / ((mr + nr) * sizeof(T)), 1);
+			const size_t mc = std::max<size_t>(cache_l2_size / 2 / (kc * sizeof(T)) / mr, 1) * mr;
+			const size_t nc = std::max<size_t>(cache_l3_size / 2 / (kc * sizeof(T)) / nr, 1) * nr;
+
+			return { mc, kc, nc };
+		}
+
+		// Grow-only per thread buffers, so repeated products do not hit the allocator
+		template <class T, int Slot>
+		T* gemm_pack_buffer(const size_t size)
+		{
+			thread_local std::vector<T> buffer;
+			if (buffer.size() < size)
+			{
+				buffer.resize(size);
+			}
+
+			return buffer.data();
+		}
+
+		// Packs an mc x kc block of A into row panels of mr rows, each stored k-major and zero padded
+		template <class T>
+		void gemm_pack_a(
+			const size_t mc, const size_t kc, const size_t mr,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			T* packed)
+		{
+			for (size_t panel_row = 0; panel_row < mc; panel_row += mr)
+			{
+				const size_t panel_rows = std::min(mr, mc - panel_row);
+				const T* a_panel = a + panel_row * a_rs;
+
+				// Untransposed A is read along its rows and scattered into the panel, transposed A is read along
+				// its columns by the loop below; either way the source is walked contiguously
+				if (a_cs == 1 && a_rs != 1)
+				{
+					for (size_t i = 0; i < mr; ++i)
+					{
+						const T* a_row = a_panel + i * a_rs;
+						for (size_t p = 0; p < kc; ++p)
+						{
+							packed[p * mr + i] = i < panel_rows ? a_row[p] : T{};
+						}
+					}
+
+					packed += kc * mr;
+					continue;
+				}
+
+				for (size_t p = 0; p < kc; ++p)
+				{
+					size_t i = 0;
+					for (; i < panel_rows; ++i)
+					{
+						*packed++ = a_panel[i * a_rs + p * a_cs];
+					}
+
+					for (; i < mr; ++i)
+					{
+						*packed++ = T{};
+					}
+				}
+			}
+		}
+
+		// Packs a kc x nc block of B into column panels of nr columns, each stored k-major and zero padded
+		template <class T>
+		void gemm_pack_b(
+			const size_t kc, const size_t nc, const size_t nr,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			T* packed)
+		{
+			for (size_t panel_column = 0; panel_column < nc; panel_column += nr)
+			{
+				const size_t panel_columns = std::min(nr, nc - panel_column);
+				const T* b_panel = b + panel_column * b_cs;
+
+				// Transposed B is read along its columns and scattered into the panel, untransposed B along its rows
+				if (b_rs == 1 && b_cs != 1)
+				{
+					for (size_t j = 0; j < nr; ++j)
+					{
+						const T* b_column = b_panel + j * b_cs;
+						for (size_t p = 0; p < kc; ++p)
+						{
+							packed[p * nr + j] = j < panel_columns ? b_column[p] : T{};
+						}
+					}
+
+					packed += kc * nr;
+					continue;
+				}
+
+				for (size_t p = 0; p < kc; ++p)
+				{
+					size_t j = 0;
+					for (; j < panel_columns; ++j)
+					{
+						*packed++ = b_panel[p * b_rs + j * b_cs];
+					}
+
+					for (; j < nr; ++j)
+					{
+						*packed++ = T{};
+					}
+				}
+			}
+		}
+
+		// C = epilogue(alpha * A * B + beta * C), operands are addressed through row and column strides so any layout can be fed in.
+		// C is not read when beta is zero.
+		template <class T, class Epilogue>
+		void gemm_blocked(
+			const GemmKernel<T>& kernel,
+			const size_t m, const size_t n, const size_t k,
+			const T& alpha,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			const T& beta,
+			T* c, const size_t c_rs, const size_t c_cs,
+			const Epilogue& epilogue)
+		{
+			const size_t mr = kernel.mr;
+			const size_t nr = kernel.nr;
+			const GemmBlocking blocking = gemm_blocking<T>(mr, nr);
+			const bool read_c = beta != T{};
+
+			if (k == 0)
+			{
+				for (size_t i = 0; i < m; ++i)
+				{
+					for (size_t j = 0; j < n; ++j)
+					{
+						T& c_value = c[i * c_rs + j * c_cs];
+						c_value = epilogue(read_c ? beta * c_value : T{}, i, j);
+					}
+				}
+
+				return;
+			}
+
+			T* const packed_a = gemm_pack_buffer<T, 0>(blocking.mc * blocking.kc);
+			T* const packed_b = gemm_pack_buffer<T, 1>(blocking.kc * ((blocking.nc + nr - 1) / nr) * nr);
+			T* const ab = gemm_pack_buffer<T, 2>(mr * nr);
+
+			for (size_t jc = 0; jc < n; jc += blocking.nc)
+			{
+				const size_t nc = std::min(blocking.nc, n - jc);
+
+				for (size_t pc = 0; pc < k; pc += blocking.kc)
+				{
+					const size_t kc = std::min(blocking.kc, k - pc);
+					const bool first_panel = pc == 0;
+					const bool last_panel = pc + kc == k;
+
+					gemm_pack_b(kc, nc, nr, b + pc * b_rs + jc * b_cs, b_rs, b_cs, packed_b);
+
+					for (size_t ic = 0; ic < m; ic += blocking.mc)
+					{
+						const size_t mc = std::min(blocking.mc, m - ic);
+
+						gemm_pack_a(mc, kc, mr, a + ic * a_rs + pc * a_cs, a_rs, a_cs, packed_a);
+
+						for (size_t jr = 0; jr < nc; jr += nr)
+						{
+							const size_t tile_columns = std::min(nr, nc - jr);
+							const T* const b_panel = packed_b + jr * kc;
+
+							for (size_t ir = 0; ir < mc; ir += mr)
+							{
+								const size_t tile_rows = std::min(mr, mc - ir);
+
+								kernel.kernel(kc, packed_a + ir * kc, b_panel, ab);
+
+								// The tile is still hot here, so scaling, accumulation and the epilogue cost no extra pass over C
+								const size_t tile_row = ic + ir;
+								const size_t tile_column = jc + jr;
+								T* const c_tile = c + tile_row * c_rs + tile_column * c_cs;
+								for (size_t i = 0; i < tile_rows; ++i)
+								{
+									for (size_t j = 0; j < tile_columns; ++j)
+									{
+										T& c_value = c_tile[i * c_rs + j * c_cs];
+
+										T value = alpha * ab[i * nr + j];
+										if (!first_panel)
+										{
+											value += c_value;
+										}
+										else if (read_c)
+										{
+											value += beta * c_value;
+										}
+
+										c_value = last_panel ? epilogue(value, tile_row + i, tile_column + j) : value;
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		template <class T>
+		void gemm_blocked(
+			const GemmKernel<T>& kernel,
+			const size_t m, const size_t n, const size_t k,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			T* c, const size_t c_rs, const size_t c_cs)
+		{
+			gemm_blocked(kernel, m, n, k, T{ 1 }, a, a_rs, a_cs, b, b_rs, b_cs, T{}, c, c_rs, c_cs, NoEpilogue{});
+		}
+
+		// C = A * B on the plain loops, C has to be zeroed, i-k-j order keeps the inner loop sequential for row-major data
+		template <class T>
+		void gemm_naive(
+			const size_t m, const size_t n, const size_t k,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			T* c, const size_t c_rs, const size_t c_cs)
+		{
+			for (size_t i = 0; i < m; ++i)
+			{
+				for (size_t p = 0; p < k; ++p)
+				{
+					const T a_value = a[i * a_rs + p * a_cs];
+					for (size_t j = 0; j < n; ++j)
+					{
+						c[i * c_rs + j * c_cs] += a_value * b[p * b_rs + j * b_cs];
+					}
+				}
+			}
+		}
+
+		template <class T>
+		bool use_gemm_engine(const size_t m, const size_t n, const size_t k)
+		{
+			return std::is_arithmetic<T>::value && m * n * k >= gemm_threshold;
+		}
+
+		inline size_t round_up(const size_t value, const size_t multiple) noexcept
+		{
+			return (value + multiple - 1) / multiple * multiple;
+		}
+
+		// Partitions C into output tiles, and the depth into kc-aligned panels while that is still too few tiles, and runs
+		// the blocked engine on every tile and panel as a task; idle threads steal whatever is ready. The first panel of a
+		// tile accumulates into C with beta, the others into private buffers, and a last task per tile adds the buffers
+		// to C and applies the epilogue
+		template <class T, class Epilogue>
+		void gemm_parallel(
+			ThreadPool& pool,
+			const size_t m, const size_t n, const size_t k,
+			const T& alpha,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			const T& beta,
+			T* c, const size_t c_rs, const size_t c_cs,
+			const Epilogue& epilogue)
+		{
+			static const GemmKernel<T> kernel = select_gemm_kernel<T>();
+
+			// Halve the larger tile side until every thread has a few tiles to balance with
+			const size_t target_tiles = pool.concurrency() * 4;
+			size_t tile_rows = round_up(m, kernel.mr);
+			size_t tile_columns = round_up(n, kernel.nr);
+			while (((m + tile_rows - 1) / tile_rows) * ((n + tile_columns - 1) / tile_columns) < target_tiles)
+			{
+				const size_t half_rows = round_up(tile_rows / 2, kernel.mr);
+				const size_t half_columns = round_up(tile_columns / 2, kernel.nr);
+				const bool can_split_rows = half_rows >= gemm_min_tile_size && half_rows < tile_rows;
+				const bool can_split_columns = half_columns >= gemm_min_tile_size && half_columns < tile_columns;
+
+				if (can_split_rows && (tile_rows >= tile_columns || !can_split_columns))
+				{
+					tile_rows = half_rows;
+				}
+				else if (can_split_columns)
+				{
+					tile_columns = half_columns;
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			const size_t row_tiles = (m + tile_rows - 1) / tile_rows;
+			const size_t column_tiles = (n + tile_columns - 1) / tile_columns;
+			const size_t tiles = row_tiles * column_tiles;
+
+			const size_t kc = gemm_blocking<T>(kernel.mr, kernel.nr).kc;
+			const size_t wanted_panels = (target_tiles + tiles - 1) / tiles;
+			const size_t depth_splits = std::max<size_t>(std::min(wanted_panels, k / kc), 1);
+			const size_t panel_depth = std::max(round_up((k + depth_splits - 1) / depth_splits, kc), kc);
+			const size_t panels = std::max<size_t>((k + panel_depth - 1) / panel_depth, 1);
+
+			const size_t tile_size = tile_rows * tile_columns;
+			std::vector<T> partials((panels - 1) * tiles * tile_size);
+
+			TaskGraph graph{ tiles * (panels > 1 ? panels + 1 : 1) };
+			for (size_t tile = 0; tile < tiles; ++tile)
+			{
+				const size_t row_begin = tile / column_tiles * tile_rows;
+				const size_t column_begin = tile % column_tiles * tile_columns;
+				const size_t rows = std::min(tile_rows, m - row_begin);
+				const size_t columns = std::min(tile_columns, n - column_begin);
+				T* const c_tile = c + row_begin * c_rs + column_begin * c_cs;
+
+				if (panels == 1)
+				{
+					graph.add([=, &epilogue]
+					{
+						gemm_blocked(
+							kernel, rows, columns, k, alpha,
+							a + row_begin * a_rs, a_rs, a_cs, b + column_begin * b_cs, b_rs, b_cs, beta, c_tile, c_rs, c_cs,
+							OffsetEpilogue<Epilogue>{ epilogue, row_begin, column_begin });
+					}, "gemm tile");
+
+					continue;
+				}
+
+				T* const tile_partials = partials.data() + tile * (panels - 1) * tile_size;
+				const TaskGraph::task_id first_panel = graph.size();
+				for (size_t panel = 0; panel < panels; ++panel)
+				{
+					const size_t depth_begin = panel * panel_depth;
+					const size_t depth = std::min(panel_depth, k - depth_begin);
+
+					graph.add([=]
+					{
+						const T* const a_panel = a + row_begin * a_rs + depth_begin * a_cs;
+						const T* const b_panel = b + depth_begin * b_rs + column_begin * b_cs;
+						if (panel == 0)
+						{
+							gemm_blocked(kernel, rows, columns, depth, alpha, a_panel, a_rs, a_cs, b_panel, b_rs, b_cs, beta, c_tile, c_rs, c_cs, NoEpilogue{});
+						}
+						else
+						{
+							T* const partial = tile_partials + (panel - 1) * tile_size;
+							gemm_blocked(kernel, rows, columns, depth, alpha, a_panel, a_rs, a_cs, b_panel, b_rs, b_cs, T{}, partial, columns, size_t{ 1 }, NoEpilogue{});
+						}
+					}, "gemm panel");
+				}
+
+				const TaskGraph::task_id reduction = graph.add([=, &epilogue]
+				{
+					for (size_t i = 0; i < rows; ++i)
+					{
+						for (size_t j = 0; j < columns; ++j)
+						{
+							T value = c_tile[i * c_rs + j * c_cs];
+							for (size_t panel = 1; panel < panels; ++panel)
+							{
+								value += tile_partials[(panel - 1) * tile_size + i * columns + j];
+							}
+
+							c_tile[i * c_rs + j * c_cs] = epilogue(value, row_begin + i, column_begin + j);
+						}
+					}
+				}, "gemm reduction");
+
+				for (size_t panel = 0; panel < panels; ++panel)
+				{
+					graph.depend(reduction, first_panel + panel);
+				}
+			}
+
+			graph.run(pool);
+		}
+
+		// Picks the plain loops, the blocked engine or its parallel variant depending on the size
+		template <class T, class Epilogue>
+		void gemm_dispatch(
+			const size_t m, const size_t n, const size_t k,
+			const T& alpha,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			const T& beta,
+			T* c, const size_t c_rs, const size_t c_cs,
+			const Epilogue& epilogue)
+		{
+			if (!use_gemm_engine<T>(m, n, k))
+			{
+				const bool read_c = beta != T{};
+				for (size_t i = 0; i < m; ++i)
+				{
+					T* const c_row = c + i * c_rs;
+					for (size_t j = 0; j < n; ++j)
+					{
+						c_row[j * c_cs] = read_c ? beta * c_row[j * c_cs] : T{};
+					}
+
+					for (size_t p = 0; p < k; ++p)
+					{
+						const T a_value = alpha * a[i * a_rs + p * a_cs];
+						for (size_t j = 0; j < n; ++j)
+						{
+							c_row[j * c_cs] += a_value * b[p * b_rs + j * b_cs];
+						}
+					}
+
+					for (size_t j = 0; j < n; ++j)
+					{
+						c_row[j * c_cs] = epilogue(c_row[j * c_cs], i, j);
+					}
+				}
+
+				return;
+			}
+
+			ThreadPool& pool = ThreadPool::instance();
+			if (pool.concurrency() > 1 && m * n * k >= gemm_parallel_threshold)
+			{
+				gemm_parallel(pool, m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, epilogue);
+				return;
+			}
+
+			static const GemmKernel<T> kernel = select_gemm_kernel<T>();
+			gemm_blocked(kernel, m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, epilogue);
+		}
+
+		// Below this many multiply-adds a mat-vec stays on the calling thread
+		constexpr size_t gemv_parallel_threshold = 256 * 1024;
+
+		// A mat-vec task covers at least this many matrix elements
+		constexpr size_t gemv_min_chunk = 32 * 1024;
+
+		// y = epilogue(alpha * A * x + beta * y) for an m x k A, the epilogue sees (i, 0); y is not read when beta is zero.
+		// A is streamed once in storage order: along rows with dot products, or along columns with axpys into a band
+		// of y, and large products split the rows of y over the pool
+		template <class T, class Epilogue>
+		void gemv(
+			const size_t m, const size_t k,
+			const T& alpha,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* x, const size_t x_stride,
+			const T& beta,
+			T* y, const size_t y_stride,
+			const Epilogue& epilogue)
+		{
+			const GemvKernels<T>& kernels = selected_gemv_kernels<T>();
+			const bool read_y = beta != T{};
+
+			// The kernels want a unit stride x, gathering it touches k elements against the m * k of A
+			if (x_stride != 1 && k > 1)
+			{
+				T* const packed_x = gemm_pack_buffer<T, 4>(k);
+				for (size_t p = 0; p < k; ++p)
+				{
+					packed_x[p] = x[p * x_stride];
+				}
+
+				x = packed_x;
+			}
+
+			T* const accumulator = a_rs == 1 && a_cs != 1 ? gemm_pack_buffer<T, 5>(m) : nullptr;
+
+			const auto rows = [&](const size_t row_begin, const size_t row_end)
+			{
+				const auto store = [&](const size_t i, const T& value)
+				{
+					T& y_value = y[i * y_stride];
+					y_value = epilogue(read_y ? value + beta * y_value : value, i, size_t{ 0 });
+				};
+
+				if (accumulator)
+				{
+					std::fill(accumulator + row_begin, accumulator + row_end, T{});
+					for (size_t p = 0; p < k; ++p)
+					{
+						kernels.axpy(row_end - row_begin, alpha * x[p], a + p * a_cs + row_begin, accumulator + row_begin);
+					}
+
+					for (size_t i = row_begin; i < row_end; ++i)
+					{
+						store(i, accumulator[i]);
+					}
+				}
+				else if (a_cs == 1)
+				{
+					for (size_t i = row_begin; i < row_end; ++i)
+					{
+						store(i, alpha * kernels.dot(k, a + i * a_rs, x));
+					}
+				}
+				else
+				{
+					for (size_t i = row_begin; i < row_end; ++i)
+					{
+						T sum{};
+						for (size_t p = 0; p < k; ++p)
+						{
+							sum += a[i * a_rs + p * a_cs] * x[p];
+						}
+
+						store(i, alpha * sum);
+					}
+				}
+			};
+
+			ThreadPool& pool = ThreadPool::instance();
+			if (pool.concurrency() > 1 && m * k >= gemv_parallel_threshold)
+			{
+				pool.parallel_for(0, m, std::max<size_t>(gemv_min_chunk / std::max<size_t>(k, 1), 1), rows);
+				return;
+			}
+
+			rows(0, m);
+		}
+
+		// C = epilogue(alpha * A * B + beta * C)
+		template <class T, class Epilogue>
+		void gemm(
+			const size_t m, const size_t n, const size_t k,
+			const T& alpha,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			const T& beta,
+			T* c, const size_t c_rs, const size_t c_cs,
+			const Epilogue& epilogue)
+		{
+			// Matrix-vector and vector-matrix products are bound by memory, packing for the micro-kernels would only add traffic
+			if (n == 1)
+			{
+				gemv(m, k, alpha, a, a_rs, a_cs, b, b_rs, beta, c, c_rs, epilogue);
+				return;
+			}
+
+			if (m == 1)
+			{
+				gemv(n, k, alpha, b, b_cs, b_rs, a, a_cs, beta, c, c_cs, TransposedEpilogue<Epilogue>{ epilogue });
+				return;
+			}
+
+			// Column-major output is computed as C^T = B^T * A^T, so every path writes along contiguous rows
+			if (c_cs != 1 && c_rs == 1)
+			{
+				gemm_dispatch(n, m, k, alpha, b, b_cs, b_rs, a, a_cs, a_rs, beta, c, c_cs, c_rs, TransposedEpilogue<Epilogue>{ epilogue });
+				return;
+			}
+
+			gemm_dispatch(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, epilogue);
+		}
+
+		// C = A * B
+		template <class T>
+		void gemm(
+			const size_t m, const size_t n, const size_t k,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			T* c, const size_t c_rs, const size_t c_cs)
+		{
+			gemm(m, n, k, T{ 1 }, a, a_rs, a_cs, b, b_rs, b_cs, T{}, c, c_rs, c_cs, NoEpilogue{});
+		}
+	}
+}
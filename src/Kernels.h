@@ -0,0 +1,1151 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define PRIM_MATRIX_X86_SIMD 1
+	#define PRIM_MATRIX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#define PRIM_MATRIX_TARGET_AVX512 __attribute__((target("avx512f")))
+	#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#define PRIM_MATRIX_X86_SIMD 1
+	#define PRIM_MATRIX_TARGET_AVX2
+	#define PRIM_MATRIX_TARGET_AVX512
+	#include <immintrin.h>
+	#include <intrin.h>
+#else
+	#define PRIM_MATRIX_X86_SIMD 0
+#endif
+
+// Fully unrolls fixed trip count loops the optimizer would otherwise keep rolled at -O2
+#if defined(__clang__)
+	#define PRIM_MATRIX_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+	#define PRIM_MATRIX_UNROLL _Pragma("GCC unroll 64")
+#else
+	#define PRIM_MATRIX_UNROLL
+#endif
+
+namespace PrimMatrix
+{
+	namespace detail
+	{
+		enum class ESimdLevel
+		{
+			scalar,
+			avx2,
+			avx512
+		};
+
+		inline ESimdLevel detect_simd_level() noexcept
+		{
+#if PRIM_MATRIX_X86_SIMD && defined(__GNUC__)
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return ESimdLevel::avx512;
+			}
+
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			{
+				return ESimdLevel::avx2;
+			}
+#elif PRIM_MATRIX_X86_SIMD
+			int registers[4];
+			__cpuid(registers, 1);
+			const bool os_saves_ymm = (registers[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+			const bool has_fma = (registers[2] & (1 << 12)) != 0;
+			if (os_saves_ymm)
+			{
+				__cpuidex(registers, 7, 0);
+				const bool os_saves_zmm = (_xgetbv(0) & 0xe6) == 0xe6;
+				if (os_saves_zmm && (registers[1] & (1 << 16)))
+				{
+					return ESimdLevel::avx512;
+				}
+
+				if (has_fma && (registers[1] & (1 << 5)))
+				{
+					return ESimdLevel::avx2;
+				}
+			}
+#endif
+			return ESimdLevel::scalar;
+		}
+
+		inline ESimdLevel simd_level() noexcept
+		{
+			static const ESimdLevel level = detect_simd_level();
+			return level;
+		}
+
+		/* GEMM MICRO-KERNELS */
+
+		// Computes an mr x nr tile of packed_a * packed_b into ab (row-major, mr x nr)
+		template <class T>
+		using gemm_micro_kernel = void(*)(size_t kc, const T* packed_a, const T* packed_b, T* ab);
+
+		template <class T>
+		struct GemmKernel
+		{
+			size_t mr;
+			size_t nr;
+			gemm_micro_kernel<T> kernel;
+		};
+
+		template <class T, size_t MR, size_t NR>
+		void micro_kernel_generic(const size_t kc, const T* packed_a, const T* packed_b, T* ab)
+		{
+			T accumulator[MR * NR]{};
+
+			for (size_t p = 0; p < kc; ++p, packed_a += MR, packed_b += NR)
+			{
+				for (size_t i = 0; i < MR; ++i)
+				{
+					const T a_value = packed_a[i];
+					for (size_t j = 0; j < NR; ++j)
+					{
+						accumulator[i * NR + j] += a_value * packed_b[j];
+					}
+				}
+			}
+
+			std::copy(accumulator, accumulator + MR * NR, ab);
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		PRIM_MATRIX_TARGET_AVX2
+		inline void micro_kernel_avx2_6x8(const size_t kc, const double* packed_a, const double* packed_b, double* ab)
+		{
+			__m256d c[6][2];
+			for (size_t i = 0; i < 6; ++i)
+			{
+				c[i][0] = c[i][1] = _mm256_setzero_pd();
+			}
+
+			for (size_t p = 0; p < kc; ++p, packed_a += 6, packed_b += 8)
+			{
+				const __m256d b0 = _mm256_loadu_pd(packed_b);
+				const __m256d b1 = _mm256_loadu_pd(packed_b + 4);
+				for (size_t i = 0; i < 6; ++i)
+				{
+					const __m256d a_value = _mm256_broadcast_sd(packed_a + i);
+					c[i][0] = _mm256_fmadd_pd(a_value, b0, c[i][0]);
+					c[i][1] = _mm256_fmadd_pd(a_value, b1, c[i][1]);
+				}
+			}
+
+			for (size_t i = 0; i < 6; ++i)
+			{
+				_mm256_storeu_pd(ab + i * 8, c[i][0]);
+				_mm256_storeu_pd(ab + i * 8 + 4, c[i][1]);
+			}
+		}
+
+		PRIM_MATRIX_TARGET_AVX2
+		inline void micro_kernel_avx2_6x16(const size_t kc, const float* packed_a, const float* packed_b, float* ab)
+		{
+			__m256 c[6][2];
+			for (size_t i = 0; i < 6; ++i)
+			{
+				c[i][0] = c[i][1] = _mm256_setzero_ps();
+			}
+
+			for (size_t p = 0; p < kc; ++p, packed_a += 6, packed_b += 16)
+			{
+				const __m256 b0 = _mm256_loadu_ps(packed_b);
+				const __m256 b1 = _mm256_loadu_ps(packed_b + 8);
+				for (size_t i = 0; i < 6; ++i)
+				{
+					const __m256 a_value = _mm256_broadcast_ss(packed_a + i);
+					c[i][0] = _mm256_fmadd_ps(a_value, b0, c[i][0]);
+					c[i][1] = _mm256_fmadd_ps(a_value, b1, c[i][1]);
+				}
+			}
+
+			for (size_t i = 0; i < 6; ++i)
+			{
+				_mm256_storeu_ps(ab + i * 16, c[i][0]);
+				_mm256_storeu_ps(ab + i * 16 + 8, c[i][1]);
+			}
+		}
+
+		PRIM_MATRIX_TARGET_AVX512
+		inline void micro_kernel_avx512_8x24(const size_t kc, const double* packed_a, const double* packed_b, double* ab)
+		{
+			__m512d c[8][3];
+			for (size_t i = 0; i < 8; ++i)
+			{
+				c[i][0] = c[i][1] = c[i][2] = _mm512_setzero_pd();
+			}
+
+			for (size_t p = 0; p < kc; ++p, packed_a += 8, packed_b += 24)
+			{
+				const __m512d b0 = _mm512_loadu_pd(packed_b);
+				const __m512d b1 = _mm512_loadu_pd(packed_b + 8);
+				const __m512d b2 = _mm512_loadu_pd(packed_b + 16);
+				for (size_t i = 0; i < 8; ++i)
+				{
+					const __m512d a_value = _mm512_set1_pd(packed_a[i]);
+					c[i][0] = _mm512_fmadd_pd(a_value, b0, c[i][0]);
+					c[i][1] = _mm512_fmadd_pd(a_value, b1, c[i][1]);
+					c[i][2] = _mm512_fmadd_pd(a_value, b2, c[i][2]);
+				}
+			}
+
+			for (size_t i = 0; i < 8; ++i)
+			{
+				_mm512_storeu_pd(ab + i * 24, c[i][0]);
+				_mm512_storeu_pd(ab + i * 24 + 8, c[i][1]);
+				_mm512_storeu_pd(ab + i * 24 + 16, c[i][2]);
+			}
+		}
+
+		PRIM_MATRIX_TARGET_AVX512
+		inline void micro_kernel_avx512_8x48(const size_t kc, const float* packed_a, const float* packed_b, float* ab)
+		{
+			__m512 c[8][3];
+			for (size_t i = 0; i < 8; ++i)
+			{
+				c[i][0] = c[i][1] = c[i][2] = _mm512_setzero_ps();
+			}
+
+			for (size_t p = 0; p < kc; ++p, packed_a += 8, packed_b += 48)
+			{
+				const __m512 b0 = _mm512_loadu_ps(packed_b);
+				const __m512 b1 = _mm512_loadu_ps(packed_b + 16);
+				const __m512 b2 = _mm512_loadu_ps(packed_b + 32);
+				for (size_t i = 0; i < 8; ++i)
+				{
+					const __m512 a_value = _mm512_set1_ps(packed_a[i]);
+					c[i][0] = _mm512_fmadd_ps(a_value, b0, c[i][0]);
+					c[i][1] = _mm512_fmadd_ps(a_value, b1, c[i][1]);
+					c[i][2] = _mm512_fmadd_ps(a_value, b2, c[i][2]);
+				}
+			}
+
+			for (size_t i = 0; i < 8; ++i)
+			{
+				_mm512_storeu_ps(ab + i * 48, c[i][0]);
+				_mm512_storeu_ps(ab + i * 48 + 16, c[i][1]);
+				_mm512_storeu_ps(ab + i * 48 + 32, c[i][2]);
+			}
+		}
+#endif
+
+		template <class T>
+		GemmKernel<T> gemm_kernel(ESimdLevel)
+		{
+			return { 4, 4, &micro_kernel_generic<T, 4, 4> };
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		template <>
+		inline GemmKernel<double> gemm_kernel<double>(const ESimdLevel level)
+		{
+			switch (level)
+			{
+			case ESimdLevel::avx512: return { 8, 24, &micro_kernel_avx512_8x24 };
+			case ESimdLevel::avx2: return { 6, 8, &micro_kernel_avx2_6x8 };
+			default: return { 4, 4, &micro_kernel_generic<double, 4, 4> };
+			}
+		}
+
+		template <>
+		inline GemmKernel<float> gemm_kernel<float>(const ESimdLevel level)
+		{
+			switch (level)
+			{
+			case ESimdLevel::avx512: return { 8, 48, &micro_kernel_avx512_8x48 };
+			case ESimdLevel::avx2: return { 6, 16, &micro_kernel_avx2_6x16 };
+			default: return { 4, 4, &micro_kernel_generic<float, 4, 4> };
+			}
+		}
+#endif
+
+		template <class T>
+		GemmKernel<T> select_gemm_kernel()
+		{
+			return gemm_kernel<T>(simd_level());
+		}
+
+		/* ELEMENT-WISE KERNELS */
+
+		enum class EElementwise
+		{
+			add,
+			subtract,
+			scale
+		};
+
+		// out[i] = lhs[i] op rhs[i] (or lhs[i] * scalar for scale), out may alias lhs or rhs
+		template <class T>
+		using elementwise_kernel = void(*)(size_t n, const T* lhs, const T* rhs, const T& scalar, T* out);
+
+		template <class T>
+		struct ElementwiseKernels
+		{
+			elementwise_kernel<T> add;
+			elementwise_kernel<T> subtract;
+			elementwise_kernel<T> scale;
+		};
+
+		template <class T, EElementwise Op>
+		void elementwise_generic(const size_t n, const T* lhs, const T* rhs, const T& scalar, T* out)
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				switch (Op)
+				{
+				case EElementwise::add: out[i] = lhs[i] + rhs[i]; break;
+				case EElementwise::subtract: out[i] = lhs[i] - rhs[i]; break;
+				case EElementwise::scale: out[i] = lhs[i] * scalar; break;
+				}
+			}
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		template <EElementwise Op>
+		PRIM_MATRIX_TARGET_AVX2
+		void elementwise_avx2(const size_t n, const double* lhs, const double* rhs, const double& scalar, double* out)
+		{
+			const __m256d scalar_value = _mm256_set1_pd(scalar);
+
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				const __m256d lhs_value = _mm256_loadu_pd(lhs + i);
+				__m256d result;
+				switch (Op)
+				{
+				case EElementwise::add: result = _mm256_add_pd(lhs_value, _mm256_loadu_pd(rhs + i)); break;
+				case EElementwise::subtract: result = _mm256_sub_pd(lhs_value, _mm256_loadu_pd(rhs + i)); break;
+				default: result = _mm256_mul_pd(lhs_value, scalar_value); break;
+				}
+
+				_mm256_storeu_pd(out + i, result);
+			}
+
+			elementwise_generic<double, Op>(n - i, lhs + i, Op == EElementwise::scale ? rhs : rhs + i, scalar, out + i);
+		}
+
+		template <EElementwise Op>
+		PRIM_MATRIX_TARGET_AVX2
+		void elementwise_avx2(const size_t n, const float* lhs, const float* rhs, const float& scalar, float* out)
+		{
+			const __m256 scalar_value = _mm256_set1_ps(scalar);
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				const __m256 lhs_value = _mm256_loadu_ps(lhs + i);
+				__m256 result;
+				switch (Op)
+				{
+				case EElementwise::add: result = _mm256_add_ps(lhs_value, _mm256_loadu_ps(rhs + i)); break;
+				case EElementwise::subtract: result = _mm256_sub_ps(lhs_value, _mm256_loadu_ps(rhs + i)); break;
+				default: result = _mm256_mul_ps(lhs_value, scalar_value); break;
+				}
+
+				_mm256_storeu_ps(out + i, result);
+			}
+
+			elementwise_generic<float, Op>(n - i, lhs + i, Op == EElementwise::scale ? rhs : rhs + i, scalar, out + i);
+		}
+
+		template <EElementwise Op>
+		PRIM_MATRIX_TARGET_AVX512
+		void elementwise_avx512(const size_t n, const double* lhs, const double* rhs, const double& scalar, double* out)
+		{
+			const __m512d scalar_value = _mm512_set1_pd(scalar);
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				const __m512d lhs_value = _mm512_loadu_pd(lhs + i);
+				__m512d result;
+				switch (Op)
+				{
+				case EElementwise::add: result = _mm512_add_pd(lhs_value, _mm512_loadu_pd(rhs + i)); break;
+				case EElementwise::subtract: result = _mm512_sub_pd(lhs_value, _mm512_loadu_pd(rhs + i)); break;
+				default: result = _mm512_mul_pd(lhs_value, scalar_value); break;
+				}
+
+				_mm512_storeu_pd(out + i, result);
+			}
+
+			elementwise_generic<double, Op>(n - i, lhs + i, Op == EElementwise::scale ? rhs : rhs + i, scalar, out + i);
+		}
+
+		template <EElementwise Op>
+		PRIM_MATRIX_TARGET_AVX512
+		void elementwise_avx512(const size_t n, const float* lhs, const float* rhs, const float& scalar, float* out)
+		{
+			const __m512 scalar_value = _mm512_set1_ps(scalar);
+
+			size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				const __m512 lhs_value = _mm512_loadu_ps(lhs + i);
+				__m512 result;
+				switch (Op)
+				{
+				case EElementwise::add: result = _mm512_add_ps(lhs_value, _mm512_loadu_ps(rhs + i)); break;
+				case EElementwise::subtract: result = _mm512_sub_ps(lhs_value, _mm512_loadu_ps(rhs + i)); break;
+				default: result = _mm512_mul_ps(lhs_value, scalar_value); break;
+				}
+
+				_mm512_storeu_ps(out + i, result);
+			}
+
+			elementwise_generic<float, Op>(n - i, lhs + i, Op == EElementwise::scale ? rhs : rhs + i, scalar, out + i);
+		}
+#endif
+
+		template <class T>
+		ElementwiseKernels<T> elementwise_kernels(ESimdLevel)
+		{
+			return {
+				&elementwise_generic<T, EElementwise::add>,
+				&elementwise_generic<T, EElementwise::subtract>,
+				&elementwise_generic<T, EElementwise::scale> };
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		template <>
+		inline ElementwiseKernels<double> elementwise_kernels<double>(const ESimdLevel level)
+		{
+			switch (level)
+			{
+			case ESimdLevel::avx512: return {
+				&elementwise_avx512<EElementwise::add>,
+				&elementwise_avx512<EElementwise::subtract>,
+				&elementwise_avx512<EElementwise::scale> };
+			case ESimdLevel::avx2: return {
+				&elementwise_avx2<EElementwise::add>,
+				&elementwise_avx2<EElementwise::subtract>,
+				&elementwise_avx2<EElementwise::scale> };
+			default: return {
+				&elementwise_generic<double, EElementwise::add>,
+				&elementwise_generic<double, EElementwise::subtract>,
+				&elementwise_generic<double, EElementwise::scale> };
+			}
+		}
+
+		template <>
+		inline ElementwiseKernels<float> elementwise_kernels<float>(const ESimdLevel level)
+		{
+			switch (level)
+			{
+			case ESimdLevel::avx512: return {
+				&elementwise_avx512<EElementwise::add>,
+				&elementwise_avx512<EElementwise::subtract>,
+				&elementwise_avx512<EElementwise::scale> };
+			case ESimdLevel::avx2: return {
+				&elementwise_avx2<EElementwise::add>,
+				&elementwise_avx2<EElementwise::subtract>,
+				&elementwise_avx2<EElementwise::scale> };
+			default: return {
+				&elementwise_generic<float, EElementwise::add>,
+				&elementwise_generic<float, EElementwise::subtract>,
+				&elementwise_generic<float, EElementwise::scale> };
+			}
+		}
+#endif
+
+		template <class T>
+		const ElementwiseKernels<T>& selected_elementwise_kernels()
+		{
+			static const ElementwiseKernels<T> kernels = elementwise_kernels<T>(simd_level());
+			return kernels;
+		}
+
+		/* GEMV KERNELS */
+
+		// Returns the sum of lhs[i] * rhs[i]
+		template <class T>
+		using dot_kernel = T(*)(size_t n, const T* lhs, const T* rhs);
+
+		// y[i] += scalar * x[i]
+		template <class T>
+		using axpy_kernel = void(*)(size_t n, const T& scalar, const T* x, T* y);
+
+		template <class T>
+		struct GemvKernels
+		{
+			dot_kernel<T> dot;
+			axpy_kernel<T> axpy;
+		};
+
+		template <class T>
+		T dot_generic(const size_t n, const T* lhs, const T* rhs)
+		{
+			T sum{};
+			for (size_t i = 0; i < n; ++i)
+			{
+				sum += lhs[i] * rhs[i];
+			}
+
+			return sum;
+		}
+
+		template <class T>
+		void axpy_generic(const size_t n, const T& scalar, const T* x, T* y)
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				y[i] += scalar * x[i];
+			}
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		// Four independent accumulators hide the FMA latency, a mat-vec streams its matrix once and is bound by memory anyway
+		PRIM_MATRIX_TARGET_AVX2
+		inline double dot_avx2(const size_t n, const double* lhs, const double* rhs)
+		{
+			__m256d sum[4] = { _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd() };
+
+			size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					sum[lane] = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + i + lane * 4), _mm256_loadu_pd(rhs + i + lane * 4), sum[lane]);
+				}
+			}
+
+			for (; i + 4 <= n; i += 4)
+			{
+				sum[0] = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i), sum[0]);
+			}
+
+			const __m256d total = _mm256_add_pd(_mm256_add_pd(sum[0], sum[1]), _mm256_add_pd(sum[2], sum[3]));
+			__m128d half = _mm_add_pd(_mm256_castpd256_pd128(total), _mm256_extractf128_pd(total, 1));
+			half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+
+			return _mm_cvtsd_f64(half) + dot_generic(n - i, lhs + i, rhs + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX2
+		inline float dot_avx2(const size_t n, const float* lhs, const float* rhs)
+		{
+			__m256 sum[4] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+
+			size_t i = 0;
+			for (; i + 32 <= n; i += 32)
+			{
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					sum[lane] = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + i + lane * 8), _mm256_loadu_ps(rhs + i + lane * 8), sum[lane]);
+				}
+			}
+
+			for (; i + 8 <= n; i += 8)
+			{
+				sum[0] = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), sum[0]);
+			}
+
+			const __m256 total = _mm256_add_ps(_mm256_add_ps(sum[0], sum[1]), _mm256_add_ps(sum[2], sum[3]));
+			__m128 half = _mm_add_ps(_mm256_castps256_ps128(total), _mm256_extractf128_ps(total, 1));
+			half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+			half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+
+			return _mm_cvtss_f32(half) + dot_generic(n - i, lhs + i, rhs + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX2
+		inline void axpy_avx2(const size_t n, const double& scalar, const double* x, double* y)
+		{
+			const __m256d scalar_value = _mm256_set1_pd(scalar);
+
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm256_storeu_pd(y + i, _mm256_fmadd_pd(scalar_value, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+			}
+
+			axpy_generic(n - i, scalar, x + i, y + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX2
+		inline void axpy_avx2(const size_t n, const float& scalar, const float* x, float* y)
+		{
+			const __m256 scalar_value = _mm256_set1_ps(scalar);
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm256_storeu_ps(y + i, _mm256_fmadd_ps(scalar_value, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+			}
+
+			axpy_generic(n - i, scalar, x + i, y + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX512
+		inline double dot_avx512(const size_t n, const double* lhs, const double* rhs)
+		{
+			__m512d sum[4] = { _mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd() };
+
+			size_t i = 0;
+			for (; i + 32 <= n; i += 32)
+			{
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					sum[lane] = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + i + lane * 8), _mm512_loadu_pd(rhs + i + lane * 8), sum[lane]);
+				}
+			}
+
+			for (; i + 8 <= n; i += 8)
+			{
+				sum[0] = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + i), _mm512_loadu_pd(rhs + i), sum[0]);
+			}
+
+			// Halved step by step as in dot_avx2. The zero-masked extract avoids GCC's _mm512_reduce_add and 512 to 256-bit
+			// casts, which go through an undefined register and trip -Wuninitialized
+			const __m512d total = _mm512_add_pd(_mm512_add_pd(sum[0], sum[1]), _mm512_add_pd(sum[2], sum[3]));
+			const __m256d quarter = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xFF, total, 0), _mm512_maskz_extractf64x4_pd(0xFF, total, 1));
+			__m128d half = _mm_add_pd(_mm256_castpd256_pd128(quarter), _mm256_extractf128_pd(quarter, 1));
+			half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+
+			return _mm_cvtsd_f64(half) + dot_generic(n - i, lhs + i, rhs + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX512
+		inline float dot_avx512(const size_t n, const float* lhs, const float* rhs)
+		{
+			__m512 sum[4] = { _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps() };
+
+			size_t i = 0;
+			for (; i + 64 <= n; i += 64)
+			{
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					sum[lane] = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + i + lane * 16), _mm512_loadu_ps(rhs + i + lane * 16), sum[lane]);
+				}
+			}
+
+			for (; i + 16 <= n; i += 16)
+			{
+				sum[0] = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + i), _mm512_loadu_ps(rhs + i), sum[0]);
+			}
+
+			const __m512d total = _mm512_castps_pd(_mm512_add_ps(_mm512_add_ps(sum[0], sum[1]), _mm512_add_ps(sum[2], sum[3])));
+			const __m256 quarter = _mm256_add_ps(
+				_mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, total, 0)),
+				_mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, total, 1)));
+			__m128 half = _mm_add_ps(_mm256_castps256_ps128(quarter), _mm256_extractf128_ps(quarter, 1));
+			half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+			half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+
+			return _mm_cvtss_f32(half) + dot_generic(n - i, lhs + i, rhs + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX512
+		inline void axpy_avx512(const size_t n, const double& scalar, const double* x, double* y)
+		{
+			const __m512d scalar_value = _mm512_set1_pd(scalar);
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				_mm512_storeu_pd(y + i, _mm512_fmadd_pd(scalar_value, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+			}
+
+			axpy_generic(n - i, scalar, x + i, y + i);
+		}
+
+		PRIM_MATRIX_TARGET_AVX512
+		inline void axpy_avx512(const size_t n, const float& scalar, const float* x, float* y)
+		{
+			const __m512 scalar_value = _mm512_set1_ps(scalar);
+
+			size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				_mm512_storeu_ps(y + i, _mm512_fmadd_ps(scalar_value, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+			}
+
+			axpy_generic(n - i, scalar, x + i, y + i);
+		}
+#endif
+
+		template <class T>
+		GemvKernels<T> gemv_kernels(ESimdLevel)
+		{
+			return { &dot_generic<T>, &axpy_generic<T> };
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		template <>
+		inline GemvKernels<double> gemv_kernels<double>(const ESimdLevel level)
+		{
+			switch (level)
+			{
+			case ESimdLevel::avx512: return { &dot_avx512, &axpy_avx512 };
+			case ESimdLevel::avx2: return { &dot_avx2, &axpy_avx2 };
+			default: return { &dot_generic<double>, &axpy_generic<double> };
+			}
+		}
+
+		template <>
+		inline GemvKernels<float> gemv_kernels<float>(const ESimdLevel level)
+		{
+			switch (level)
+			{
+			case ESimdLevel::avx512: return { &dot_avx512, &axpy_avx512 };
+			case ESimdLevel::avx2: return { &dot_avx2, &axpy_avx2 };
+			default: return { &dot_generic<float>, &axpy_generic<float> };
+			}
+		}
+#endif
+
+		template <class T>
+		const GemvKernels<T>& selected_gemv_kernels()
+		{
+			static const GemvKernels<T> kernels = gemv_kernels<T>(simd_level());
+			return kernels;
+		}
+
+		/* BATCHED SMALL-MATRIX KERNELS */
+
+		// Multiplies `lanes` interleaved Rows x Common by Common x Columns products at once: element e of matrix l
+		// lives at [e * stride + l] (elements row by row), so one vector register holds the same element of every matrix.
+		// stride is lanes for a packed group and the length of the element arrays for an SMatrixBatch. Every output
+		// column of a row has its own accumulator, which keeps Columns FMA chains in flight
+		template <class T>
+		using batch_multiply_kernel = void(*)(const T* lhs, const T* rhs, T* out, size_t stride);
+
+		template <class T>
+		struct BatchMultiplyKernel
+		{
+			size_t lanes;
+			batch_multiply_kernel<T> kernel;
+		};
+
+		// Widest lane count of the batch kernels
+		constexpr size_t batch_max_lanes = 16;
+
+		template <class T, size_t Rows, size_t Common, size_t Columns, size_t Lanes>
+		void batch_multiply_generic(const T* lhs, const T* rhs, T* out, const size_t stride)
+		{
+			for (size_t i = 0; i < Rows; ++i)
+			{
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					T sum[Lanes]{};
+					for (size_t p = 0; p < Common; ++p)
+					{
+						const T* const lhs_lanes = lhs + (i * Common + p) * stride;
+						const T* const rhs_lanes = rhs + (p * Columns + j) * stride;
+						for (size_t lane = 0; lane < Lanes; ++lane)
+						{
+							sum[lane] += lhs_lanes[lane] * rhs_lanes[lane];
+						}
+					}
+
+					std::copy(sum, sum + Lanes, out + (i * Columns + j) * stride);
+				}
+			}
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		template <size_t Rows, size_t Common, size_t Columns>
+		PRIM_MATRIX_TARGET_AVX2
+		void batch_multiply_avx2(const double* lhs, const double* rhs, double* out, const size_t stride)
+		{
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < Rows; ++i)
+			{
+				__m256d sum[Columns];
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					sum[j] = _mm256_setzero_pd();
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t p = 0; p < Common; ++p)
+				{
+					const __m256d lhs_value = _mm256_loadu_pd(lhs + (i * Common + p) * stride);
+					PRIM_MATRIX_UNROLL
+					for (size_t j = 0; j < Columns; ++j)
+					{
+						sum[j] = _mm256_fmadd_pd(lhs_value, _mm256_loadu_pd(rhs + (p * Columns + j) * stride), sum[j]);
+					}
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					_mm256_storeu_pd(out + (i * Columns + j) * stride, sum[j]);
+				}
+			}
+		}
+
+		template <size_t Rows, size_t Common, size_t Columns>
+		PRIM_MATRIX_TARGET_AVX2
+		void batch_multiply_avx2(const float* lhs, const float* rhs, float* out, const size_t stride)
+		{
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < Rows; ++i)
+			{
+				__m256 sum[Columns];
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					sum[j] = _mm256_setzero_ps();
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t p = 0; p < Common; ++p)
+				{
+					const __m256 lhs_value = _mm256_loadu_ps(lhs + (i * Common + p) * stride);
+					PRIM_MATRIX_UNROLL
+					for (size_t j = 0; j < Columns; ++j)
+					{
+						sum[j] = _mm256_fmadd_ps(lhs_value, _mm256_loadu_ps(rhs + (p * Columns + j) * stride), sum[j]);
+					}
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					_mm256_storeu_ps(out + (i * Columns + j) * stride, sum[j]);
+				}
+			}
+		}
+
+		template <size_t Rows, size_t Common, size_t Columns>
+		PRIM_MATRIX_TARGET_AVX512
+		void batch_multiply_avx512(const double* lhs, const double* rhs, double* out, const size_t stride)
+		{
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < Rows; ++i)
+			{
+				__m512d sum[Columns];
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					sum[j] = _mm512_setzero_pd();
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t p = 0; p < Common; ++p)
+				{
+					const __m512d lhs_value = _mm512_loadu_pd(lhs + (i * Common + p) * stride);
+					PRIM_MATRIX_UNROLL
+					for (size_t j = 0; j < Columns; ++j)
+					{
+						sum[j] = _mm512_fmadd_pd(lhs_value, _mm512_loadu_pd(rhs + (p * Columns + j) * stride), sum[j]);
+					}
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					_mm512_storeu_pd(out + (i * Columns + j) * stride, sum[j]);
+				}
+			}
+		}
+
+		template <size_t Rows, size_t Common, size_t Columns>
+		PRIM_MATRIX_TARGET_AVX512
+		void batch_multiply_avx512(const float* lhs, const float* rhs, float* out, const size_t stride)
+		{
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < Rows; ++i)
+			{
+				__m512 sum[Columns];
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					sum[j] = _mm512_setzero_ps();
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t p = 0; p < Common; ++p)
+				{
+					const __m512 lhs_value = _mm512_loadu_ps(lhs + (i * Common + p) * stride);
+					PRIM_MATRIX_UNROLL
+					for (size_t j = 0; j < Columns; ++j)
+					{
+						sum[j] = _mm512_fmadd_ps(lhs_value, _mm512_loadu_ps(rhs + (p * Columns + j) * stride), sum[j]);
+					}
+				}
+
+				PRIM_MATRIX_UNROLL
+				for (size_t j = 0; j < Columns; ++j)
+				{
+					_mm512_storeu_ps(out + (i * Columns + j) * stride, sum[j]);
+				}
+			}
+		}
+#endif
+
+		// Function templates cannot be partially specialized on T, so the selection goes through a class
+		template <class T, size_t Rows, size_t Common, size_t Columns>
+		struct BatchMultiplyKernels
+		{
+			static BatchMultiplyKernel<T> select(ESimdLevel)
+			{
+				return { 4, &batch_multiply_generic<T, Rows, Common, Columns, 4> };
+			}
+		};
+
+#if PRIM_MATRIX_X86_SIMD
+		template <size_t Rows, size_t Common, size_t Columns>
+		struct BatchMultiplyKernels<double, Rows, Common, Columns>
+		{
+			static BatchMultiplyKernel<double> select(const ESimdLevel level)
+			{
+				switch (level)
+				{
+				case ESimdLevel::avx512: return { 8, &batch_multiply_avx512<Rows, Common, Columns> };
+				case ESimdLevel::avx2: return { 4, &batch_multiply_avx2<Rows, Common, Columns> };
+				default: return { 4, &batch_multiply_generic<double, Rows, Common, Columns, 4> };
+				}
+			}
+		};
+
+		template <size_t Rows, size_t Common, size_t Columns>
+		struct BatchMultiplyKernels<float, Rows, Common, Columns>
+		{
+			static BatchMultiplyKernel<float> select(const ESimdLevel level)
+			{
+				switch (level)
+				{
+				case ESimdLevel::avx512: return { 16, &batch_multiply_avx512<Rows, Common, Columns> };
+				case ESimdLevel::avx2: return { 8, &batch_multiply_avx2<Rows, Common, Columns> };
+				default: return { 8, &batch_multiply_generic<float, Rows, Common, Columns, 8> };
+				}
+			}
+		};
+#endif
+
+		template <class T, size_t Rows, size_t Common, size_t Columns>
+		BatchMultiplyKernel<T> batch_multiply_kernel_for(const ESimdLevel level)
+		{
+			return BatchMultiplyKernels<T, Rows, Common, Columns>::select(level);
+		}
+
+		template <class T, size_t Rows, size_t Common, size_t Columns>
+		const BatchMultiplyKernel<T>& selected_batch_multiply_kernel()
+		{
+			static const BatchMultiplyKernel<T> kernel = batch_multiply_kernel_for<T, Rows, Common, Columns>(simd_level());
+			return kernel;
+		}
+
+		// Multiplies count dense row-major products stored one matrix after another. Shapes whose matrices fill whole
+		// registers are multiplied in place, the lanes of a register covering one product, so they skip the interleaving
+		// that costs as much as the products themselves; the other shapes have none
+		template <class T>
+		using batch_multiply_dense_kernel = void(*)(const T* lhs, const T* rhs, T* out, size_t count);
+
+#if PRIM_MATRIX_X86_SIMD
+		// A register holds rows 0-1 and 2-3; an in-lane permute spreads lhs(i, p) over row i, rhs row p is broadcast from memory
+		PRIM_MATRIX_TARGET_AVX2
+		inline void batch_multiply_dense_avx2_4x4(const float* lhs, const float* rhs, float* out, const size_t count)
+		{
+			for (size_t matrix = 0; matrix < count; ++matrix)
+			{
+				const float* const a = lhs + matrix * 16;
+				const float* const b = rhs + matrix * 16;
+				const __m256 a01 = _mm256_loadu_ps(a);
+				const __m256 a23 = _mm256_loadu_ps(a + 8);
+
+				__m256 b_row = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+				__m256 sum01 = _mm256_mul_ps(_mm256_permute_ps(a01, 0x00), b_row);
+				__m256 sum23 = _mm256_mul_ps(_mm256_permute_ps(a23, 0x00), b_row);
+
+				b_row = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+				sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0x55), b_row, sum01);
+				sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0x55), b_row, sum23);
+
+				b_row = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+				sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xAA), b_row, sum01);
+				sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0xAA), b_row, sum23);
+
+				b_row = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+				sum01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xFF), b_row, sum01);
+				sum23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0xFF), b_row, sum23);
+
+				_mm256_storeu_ps(out + matrix * 16, sum01);
+				_mm256_storeu_ps(out + matrix * 16 + 8, sum23);
+			}
+		}
+
+		// One register holds the whole matrix, a 128-bit lane per row. The masked forms keep GCC 12 from warning about
+		// the undefined source of the plain ones
+		PRIM_MATRIX_TARGET_AVX512
+		inline void batch_multiply_dense_avx512_4x4(const float* lhs, const float* rhs, float* out, const size_t count)
+		{
+			for (size_t matrix = 0; matrix < count; ++matrix)
+			{
+				const __m512 a = _mm512_loadu_ps(lhs + matrix * 16);
+				const float* const b = rhs + matrix * 16;
+
+				__m512 sum = _mm512_mul_ps(_mm512_maskz_permute_ps(0xFFFF, a, 0x00), _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(b)));
+				sum = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, a, 0x55), _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(b + 4)), sum);
+				sum = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, a, 0xAA), _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(b + 8)), sum);
+				sum = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, a, 0xFF), _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(b + 12)), sum);
+
+				_mm512_storeu_ps(out + matrix * 16, sum);
+			}
+		}
+#endif
+
+		template <class T, size_t Rows, size_t Common, size_t Columns>
+		struct BatchMultiplyDenseKernels
+		{
+			static batch_multiply_dense_kernel<T> select(ESimdLevel)
+			{
+				return nullptr;
+			}
+		};
+
+#if PRIM_MATRIX_X86_SIMD
+		template <>
+		struct BatchMultiplyDenseKernels<float, 4, 4, 4>
+		{
+			static batch_multiply_dense_kernel<float> select(const ESimdLevel level)
+			{
+				switch (level)
+				{
+				case ESimdLevel::avx512: return &batch_multiply_dense_avx512_4x4;
+				case ESimdLevel::avx2: return &batch_multiply_dense_avx2_4x4;
+				default: return nullptr;
+				}
+			}
+		};
+#endif
+
+		template <class T, size_t Rows, size_t Common, size_t Columns>
+		batch_multiply_dense_kernel<T> selected_batch_multiply_dense_kernel()
+		{
+			static const batch_multiply_dense_kernel<T> kernel = BatchMultiplyDenseKernels<T, Rows, Common, Columns>::select(simd_level());
+			return kernel;
+		}
+
+		/* TRANSPOSE KERNELS */
+
+		// Transposes a block x block tile: dst[j * dst_ld + i] = src[i * src_ld + j]
+		template <class T>
+		using transpose_block_kernel = void(*)(const T* src, size_t src_ld, T* dst, size_t dst_ld);
+
+		template <class T>
+		struct TransposeKernel
+		{
+			size_t block;
+			transpose_block_kernel<T> kernel;
+		};
+
+		template <class T, size_t Block>
+		void transpose_block_generic(const T* src, const size_t src_ld, T* dst, const size_t dst_ld)
+		{
+			for (size_t i = 0; i < Block; ++i)
+			{
+				for (size_t j = 0; j < Block; ++j)
+				{
+					dst[j * dst_ld + i] = src[i * src_ld + j];
+				}
+			}
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		PRIM_MATRIX_TARGET_AVX2
+		inline void transpose_block_avx2_4x4(const double* src, const size_t src_ld, double* dst, const size_t dst_ld)
+		{
+			const __m256d r0 = _mm256_loadu_pd(src);
+			const __m256d r1 = _mm256_loadu_pd(src + src_ld);
+			const __m256d r2 = _mm256_loadu_pd(src + 2 * src_ld);
+			const __m256d r3 = _mm256_loadu_pd(src + 3 * src_ld);
+
+			// Pairs within 128-bit lanes, then swaps the lanes across
+			const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+			const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+			const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+			const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+			_mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+			_mm256_storeu_pd(dst + dst_ld, _mm256_permute2f128_pd(t1, t3, 0x20));
+			_mm256_storeu_pd(dst + 2 * dst_ld, _mm256_permute2f128_pd(t0, t2, 0x31));
+			_mm256_storeu_pd(dst + 3 * dst_ld, _mm256_permute2f128_pd(t1, t3, 0x31));
+		}
+
+		PRIM_MATRIX_TARGET_AVX2
+		inline void transpose_block_avx2_8x8(const float* src, const size_t src_ld, float* dst, const size_t dst_ld)
+		{
+			__m256 r[8];
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < 8; ++i)
+			{
+				r[i] = _mm256_loadu_ps(src + i * src_ld);
+			}
+
+			// Interleaves pairs of rows, then pairs of pairs, then swaps the 128-bit lanes across
+			__m256 t[8];
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < 8; i += 2)
+			{
+				t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+				t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+			}
+
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < 8; i += 4)
+			{
+				r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+				r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+				r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+				r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+			}
+
+			PRIM_MATRIX_UNROLL
+			for (size_t i = 0; i < 4; ++i)
+			{
+				_mm256_storeu_ps(dst + i * dst_ld, _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+				_mm256_storeu_ps(dst + (i + 4) * dst_ld, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+			}
+		}
+#endif
+
+		template <class T>
+		TransposeKernel<T> transpose_kernel(ESimdLevel)
+		{
+			return { 4, &transpose_block_generic<T, 4> };
+		}
+
+#if PRIM_MATRIX_X86_SIMD
+		// AVX-512 machines run the AVX2 tiles, a transpose is bound by memory rather than shuffles
+		template <>
+		inline TransposeKernel<double> transpose_kernel<double>(const ESimdLevel level)
+		{
+			if (level == ESimdLevel::scalar)
+			{
+				return { 4, &transpose_block_generic<double, 4> };
+			}
+
+			return { 4, &transpose_block_avx2_4x4 };
+		}
+
+		template <>
+		inline TransposeKernel<float> transpose_kernel<float>(const ESimdLevel level)
+		{
+			if (level == ESimdLevel::scalar)
+			{
+				return { 8, &transpose_block_generic<float, 8> };
+			}
+
+			return { 8, &transpose_block_avx2_8x8 };
+		}
+#endif
+
+		template <class T>
+		const TransposeKernel<T>& selected_transpose_kernel()
+		{
+			static const TransposeKernel<T> kernel = transpose_kernel<T>(simd_level());
+			return kernel;
+		}
+	}
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "Matrix_Exception.h"
+
+namespace PrimMatrix
+{
+	template <class T, class Alloc, class Order>
+	class DMatrix;
+
+	// CRTP base of everything that can appear in an element-wise expression.
+	// Derived types provide value_type, rows(), columns() and operator()(row, column).
+	template <class Derived>
+	class MatrixExpression
+	{
+	public:
+		const Derived& derived() const noexcept
+		{
+			return static_cast<const Derived&>(*this);
+		}
+	};
+
+	namespace detail
+	{
+		// Matrices are referenced by the nodes, nodes themselves are small and copied
+		template <class Expression>
+		struct expression_storage
+		{
+			using type = const Expression;
+		};
+
+		template <class T, class Alloc, class Order>
+		struct expression_storage<DMatrix<T, Alloc, Order>>
+		{
+			using type = const DMatrix<T, Alloc, Order>&;
+		};
+
+		struct AddOperation
+		{
+			static constexpr Matrix_OperationMatrixMismatch::EOperation operation = Matrix_OperationMatrixMismatch::EOperation::addition;
+
+			template <class T>
+			static T apply(const T& lhs, const T& rhs)
+			{
+				return lhs + rhs;
+			}
+		};
+
+		struct SubtractOperation
+		{
+			static constexpr Matrix_OperationMatrixMismatch::EOperation operation = Matrix_OperationMatrixMismatch::EOperation::subtraction;
+
+			template <class T>
+			static T apply(const T& lhs, const T& rhs)
+			{
+				return lhs - rhs;
+			}
+		};
+
+		struct ScaleRightOperation
+		{
+			template <class T>
+			static T apply(const T& value, const T& scalar)
+			{
+				return value * scalar;
+			}
+		};
+
+		struct ScaleLeftOperation
+		{
+			template <class T>
+			static T apply(const T& value, const T& scalar)
+			{
+				return scalar * value;
+			}
+		};
+	}
+
+	template <class Lhs, class Rhs, class Operation>
+	class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<Lhs, Rhs, Operation>>
+	{
+		static_assert(std::is_same<typename Lhs::value_type, typename Rhs::value_type>::value, "Matrix value types have to match");
+
+	public:
+		using value_type = typename Lhs::value_type;
+		using size_type = size_t;
+
+		explicit MatrixBinaryExpression(const Lhs& lhs, const Rhs& rhs) :
+			lhs_{ lhs },
+			rhs_{ rhs }
+		{
+			if (lhs.rows() != rhs.rows() ||
+				lhs.columns() != rhs.columns())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					Operation::operation,
+					lhs.rows(),
+					lhs.columns(),
+					rhs.rows(),
+					rhs.columns() };
+			}
+		}
+
+		size_type rows() const noexcept { return lhs_.rows(); }
+		size_type columns() const noexcept { return lhs_.columns(); }
+		size_type size() const noexcept { return rows() * columns(); }
+
+		value_type operator()(const size_type row, const size_type column) const
+		{
+			return Operation::apply(lhs_(row, column), rhs_(row, column));
+		}
+
+		const Lhs& lhs() const noexcept { return lhs_; }
+		const Rhs& rhs() const noexcept { return rhs_; }
+
+	private:
+		typename detail::expression_storage<Lhs>::type lhs_;
+		typename detail::expression_storage<Rhs>::type rhs_;
+	};
+
+	template <class Expression, class Operation>
+	class MatrixScalarExpression : public MatrixExpression<MatrixScalarExpression<Expression, Operation>>
+	{
+	public:
+		using value_type = typename Expression::value_type;
+		using size_type = size_t;
+
+		explicit MatrixScalarExpression(const Expression& expression, const value_type& scalar) :
+			expression_{ expression },
+			scalar_{ scalar }
+		{
+
+		}
+
+		size_type rows() const noexcept { return expression_.rows(); }
+		size_type columns() const noexcept { return expression_.columns(); }
+		size_type size() const noexcept { return rows() * columns(); }
+
+		value_type operator()(const size_type row, const size_type column) const
+		{
+			return Operation::apply(expression_(row, column), scalar_);
+		}
+
+		const Expression& expression() const noexcept { return expression_; }
+		const value_type& scalar() const noexcept { return scalar_; }
+
+	private:
+		typename detail::expression_storage<Expression>::type expression_;
+		value_type scalar_;
+	};
+
+	template <class Lhs, class Rhs>
+	MatrixBinaryExpression<Lhs, Rhs, detail::AddOperation> operator+(
+		const MatrixExpression<Lhs>& lhs,
+		const MatrixExpression<Rhs>& rhs)
+	{
+		return MatrixBinaryExpression<Lhs, Rhs, detail::AddOperation>{ lhs.derived(), rhs.derived() };
+	}
+
+	template <class Lhs, class Rhs>
+	MatrixBinaryExpression<Lhs, Rhs, detail::SubtractOperation> operator-(
+		const MatrixExpression<Lhs>& lhs,
+		const MatrixExpression<Rhs>& rhs)
+	{
+		return MatrixBinaryExpression<Lhs, Rhs, detail::SubtractOperation>{ lhs.derived(), rhs.derived() };
+	}
+
+	template <class Expression>
+	MatrixScalarExpression<Expression, detail::ScaleRightOperation> operator*(
+		const MatrixExpression<Expression>& lhs,
+		const typename Expression::value_type& rhs)
+	{
+		return MatrixScalarExpression<Expression, detail::ScaleRightOperation>{ lhs.derived(), rhs };
+	}
+
+	template <class Expression>
+	MatrixScalarExpression<Expression, detail::ScaleLeftOperation> operator*(
+		const typename Expression::value_type& lhs,
+		const MatrixExpression<Expression>& rhs)
+	{
+		return MatrixScalarExpression<Expression, detail::ScaleLeftOperation>{ rhs.derived(), lhs };
+	}
+}
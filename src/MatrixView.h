@@ -0,0 +1,457 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Matrix_Exception.h"
+#include "MatrixExpression.h"
+#include "StorageOrder.h"
+
+namespace PrimMatrix
+{
+	// Walks a block in storage order line by line, skipping the gap between the end of a line and the next line's start
+	template <class T>
+	class StridedIterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename std::remove_const<T>::type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T*;
+		using reference = T&;
+
+		StridedIterator() noexcept = default;
+
+		explicit StridedIterator(T* position, T* line_end, const size_t line_size, const size_t leading_dimension) noexcept :
+			position_{ position },
+			line_end_{ line_end },
+			line_size_{ line_size },
+			leading_dimension_{ leading_dimension }
+		{
+
+		}
+
+		// Allows iterator -> const_iterator
+		template <class U, class = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		StridedIterator(const StridedIterator<U>& other) noexcept :
+			position_{ other.position() },
+			line_end_{ other.line_end() },
+			line_size_{ other.line_size() },
+			leading_dimension_{ other.leading_dimension() }
+		{
+
+		}
+
+		reference operator*() const noexcept { return *position_; }
+		pointer operator->() const noexcept { return position_; }
+
+		StridedIterator& operator++() noexcept
+		{
+			if (++position_ == line_end_)
+			{
+				position_ += leading_dimension_ - line_size_;
+				line_end_ += leading_dimension_;
+			}
+
+			return *this;
+		}
+
+		StridedIterator operator++(int) noexcept
+		{
+			StridedIterator previous{ *this };
+			++*this;
+			return previous;
+		}
+
+		T* position() const noexcept { return position_; }
+		T* line_end() const noexcept { return line_end_; }
+		size_t line_size() const noexcept { return line_size_; }
+		size_t leading_dimension() const noexcept { return leading_dimension_; }
+
+		friend bool operator==(const StridedIterator& lhs, const StridedIterator& rhs) noexcept
+		{
+			return lhs.position_ == rhs.position_;
+		}
+
+		friend bool operator!=(const StridedIterator& lhs, const StridedIterator& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+
+	private:
+		T* position_ = nullptr;
+		T* line_end_ = nullptr;
+		size_t line_size_ = 0;
+		size_t leading_dimension_ = 0;
+	};
+
+	namespace detail
+	{
+		template <class T>
+		StridedIterator<T> strided_begin(T* data, const size_t lines, const size_t line_size, const size_t leading_dimension) noexcept
+		{
+			if (lines == 0 || line_size == 0)
+			{
+				return StridedIterator<T>{ data, data, line_size, leading_dimension };
+			}
+
+			return StridedIterator<T>{ data, data + line_size, line_size, leading_dimension };
+		}
+
+		template <class T>
+		StridedIterator<T> strided_end(T* data, const size_t lines, const size_t line_size, const size_t leading_dimension) noexcept
+		{
+			if (lines == 0 || line_size == 0)
+			{
+				return StridedIterator<T>{ data, data, line_size, leading_dimension };
+			}
+
+			T* const end = data + lines * leading_dimension;
+			return StridedIterator<T>{ end, end + line_size, line_size, leading_dimension };
+		}
+
+		inline void check_view_splice(const Splice& splice, const size_t rows, const size_t columns)
+		{
+			if (splice.row_begin + splice.row_count > rows ||
+				splice.column_begin + splice.column_count > columns)
+			{
+				throw Matrix_SpliceOutOfBounds{ splice, rows, columns };
+			}
+		}
+	}
+
+	// Non-owning, read-only window on dense data: element (row, column) lives at data[Order::offset(row, column, leading_dimension)].
+	// The viewed storage has to outlive the view.
+	template <class T, class Order = RowMajor>
+	class ConstMatrixView : public MatrixExpression<ConstMatrixView<T, Order>>
+	{
+	public:
+		using value_type = T;
+		using order_type = Order;
+		using size_type = size_t;
+		using reference = const T&;
+		using const_reference = const T&;
+		using pointer = const T*;
+		using const_pointer = const T*;
+		using iterator = StridedIterator<const T>;
+		using const_iterator = StridedIterator<const T>;
+
+		explicit ConstMatrixView(const_pointer data, const size_type row_count, const size_type column_count, const size_type leading_dimension) noexcept :
+			data_{ data },
+			rows_{ row_count },
+			columns_{ column_count },
+			leading_dimension_{ leading_dimension }
+		{
+
+		}
+
+		explicit ConstMatrixView(const_pointer data, const size_type row_count, const size_type column_count) noexcept :
+			ConstMatrixView{ data, row_count, column_count, Order::line_size(row_count, column_count) }
+		{
+
+		}
+
+		size_type rows() const noexcept { return rows_; }
+		size_type columns() const noexcept { return columns_; }
+		size_type size() const noexcept { return rows_ * columns_; }
+		size_type leading_dimension() const noexcept { return leading_dimension_; }
+
+		const_pointer data() const noexcept { return data_; }
+
+		const_reference at(const size_type row, const size_type column) const
+		{
+			if (row >= rows() ||
+				column >= columns())
+			{
+				throw Matrix_RowColOutOfBounds{ row, column, rows(), columns() };
+			}
+
+			return (*this)(row, column);
+		}
+
+		const_reference operator()(const size_type row, const size_type column) const
+		{
+			return data_[Order::offset(row, column, leading_dimension_)];
+		}
+
+		// Iteration follows the storage order
+		const_iterator begin() const noexcept { return cbegin(); }
+		const_iterator end() const noexcept { return cend(); }
+		const_iterator cbegin() const noexcept { return detail::strided_begin(data_, lines(), line_size(), leading_dimension_); }
+		const_iterator cend() const noexcept { return detail::strided_end(data_, lines(), line_size(), leading_dimension_); }
+
+		ConstMatrixView view() const noexcept
+		{
+			return *this;
+		}
+
+		ConstMatrixView view(const Splice& splice) const
+		{
+			detail::check_view_splice(splice, rows(), columns());
+			return ConstMatrixView{ data_ + Order::offset(splice.row_begin, splice.column_begin, leading_dimension_), splice.row_count, splice.column_count, leading_dimension_ };
+		}
+
+		// Same storage read in the other order, nothing is copied
+		ConstMatrixView<T, typename Order::transposed> t() const noexcept
+		{
+			return ConstMatrixView<T, typename Order::transposed>{ data_, columns_, rows_, leading_dimension_ };
+		}
+
+	private:
+		size_type lines() const noexcept { return Order::lines(rows_, columns_); }
+		size_type line_size() const noexcept { return Order::line_size(rows_, columns_); }
+
+		const_pointer data_;
+		size_type rows_, columns_, leading_dimension_;
+	};
+
+	template <class T, class Order>
+	class MatrixView;
+
+	namespace detail
+	{
+		inline bool views_overlap(const void* lhs_begin, const void* lhs_end, const void* rhs_begin, const void* rhs_end)
+		{
+			const std::less<const void*> less{};
+			return less(lhs_begin, rhs_end) && less(rhs_begin, lhs_end);
+		}
+
+		template <class T, class Order>
+		const T* view_storage_end(const ConstMatrixView<T, Order>& view)
+		{
+			return view.data() + (Order::lines(view.rows(), view.columns()) - 1) * view.leading_dimension() + Order::line_size(view.rows(), view.columns());
+		}
+
+		template <class T, class LhsOrder, class RhsOrder>
+		bool views_overlap(const ConstMatrixView<T, LhsOrder>& lhs, const ConstMatrixView<T, RhsOrder>& rhs)
+		{
+			if (lhs.size() == 0 || rhs.size() == 0)
+			{
+				return false;
+			}
+
+			return views_overlap(lhs.data(), view_storage_end(lhs), rhs.data(), view_storage_end(rhs));
+		}
+
+		// Whether writing an expression element by element into destination can overwrite elements it still has to read.
+		// Each element is read right before the same position is written, so only operands overlapping the destination
+		// in another layout count, e.g. its transpose or a shifted window of it
+		template <class T, class Order, class U, class LeafOrder>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const ConstMatrixView<U, LeafOrder>& operand);
+
+		template <class T, class Order, class U, class LeafOrder>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const MatrixView<U, LeafOrder>& operand);
+
+		template <class T, class Order, class U, class Alloc, class LeafOrder>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const DMatrix<U, Alloc, LeafOrder>& operand);
+
+		template <class T, class Order, class Lhs, class Rhs, class Operation>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const MatrixBinaryExpression<Lhs, Rhs, Operation>& expression);
+
+		template <class T, class Order, class Expression, class Operation>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const MatrixScalarExpression<Expression, Operation>& expression);
+	}
+
+	// Mutable counterpart of ConstMatrixView. Copying a view copies the window, assigning to a view writes through to the elements.
+	template <class T, class Order = RowMajor>
+	class MatrixView : public MatrixExpression<MatrixView<T, Order>>
+	{
+	public:
+		using value_type = T;
+		using order_type = Order;
+		using size_type = size_t;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using iterator = StridedIterator<T>;
+		using const_iterator = StridedIterator<const T>;
+
+		explicit MatrixView(pointer data, const size_type row_count, const size_type column_count, const size_type leading_dimension) noexcept :
+			data_{ data },
+			rows_{ row_count },
+			columns_{ column_count },
+			leading_dimension_{ leading_dimension }
+		{
+
+		}
+
+		explicit MatrixView(pointer data, const size_type row_count, const size_type column_count) noexcept :
+			MatrixView{ data, row_count, column_count, Order::line_size(row_count, column_count) }
+		{
+
+		}
+
+		MatrixView(const MatrixView&) = default;
+
+		operator ConstMatrixView<T, Order>() const noexcept
+		{
+			return ConstMatrixView<T, Order>{ data_, rows_, columns_, leading_dimension_ };
+		}
+
+		MatrixView& operator=(const MatrixView& rhs)
+		{
+			return *this = static_cast<const MatrixExpression<MatrixView>&>(rhs);
+		}
+
+		template <class Expression>
+		MatrixView& operator=(const MatrixExpression<Expression>& expression)
+		{
+			const Expression& source = expression.derived();
+			if (rows() != source.rows() ||
+				columns() != source.columns())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					Matrix_OperationMatrixMismatch::EOperation::assignment,
+					rows(),
+					columns(),
+					source.rows(),
+					source.columns() };
+			}
+
+			if (detail::expression_aliases(ConstMatrixView<T, Order>{ *this }, source))
+			{
+				std::vector<value_type> values;
+				values.reserve(size());
+				detail::for_each_index<Order>(rows(), columns(), [&](const size_type row, const size_type column)
+				{
+					values.push_back(source(row, column));
+				});
+
+				auto value = values.begin();
+				detail::for_each_index<Order>(rows(), columns(), [&](const size_type row, const size_type column)
+				{
+					(*this)(row, column) = std::move(*value++);
+				});
+
+				return *this;
+			}
+
+			detail::for_each_index<Order>(rows(), columns(), [&](const size_type row, const size_type column)
+			{
+				(*this)(row, column) = source(row, column);
+			});
+
+			return *this;
+		}
+
+		template <class Expression>
+		MatrixView& operator+=(const MatrixExpression<Expression>& rhs)
+		{
+			return *this = *this + rhs;
+		}
+
+		template <class Expression>
+		MatrixView& operator-=(const MatrixExpression<Expression>& rhs)
+		{
+			return *this = *this - rhs;
+		}
+
+		MatrixView& operator*=(const value_type& rhs)
+		{
+			return *this = *this * rhs;
+		}
+
+		size_type rows() const noexcept { return rows_; }
+		size_type columns() const noexcept { return columns_; }
+		size_type size() const noexcept { return rows_ * columns_; }
+		size_type leading_dimension() const noexcept { return leading_dimension_; }
+
+		pointer data() const noexcept { return data_; }
+
+		reference at(const size_type row, const size_type column) const
+		{
+			if (row >= rows() ||
+				column >= columns())
+			{
+				throw Matrix_RowColOutOfBounds{ row, column, rows(), columns() };
+			}
+
+			return (*this)(row, column);
+		}
+
+		reference operator()(const size_type row, const size_type column) const
+		{
+			return data_[Order::offset(row, column, leading_dimension_)];
+		}
+
+		// Iteration follows the storage order
+		iterator begin() const noexcept { return detail::strided_begin(data_, lines(), line_size(), leading_dimension_); }
+		iterator end() const noexcept { return detail::strided_end(data_, lines(), line_size(), leading_dimension_); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+
+		MatrixView view() const noexcept
+		{
+			return *this;
+		}
+
+		MatrixView view(const Splice& splice) const
+		{
+			detail::check_view_splice(splice, rows(), columns());
+			return MatrixView{ data_ + Order::offset(splice.row_begin, splice.column_begin, leading_dimension_), splice.row_count, splice.column_count, leading_dimension_ };
+		}
+
+		// Same storage read in the other order, nothing is copied
+		MatrixView<T, typename Order::transposed> t() const noexcept
+		{
+			return MatrixView<T, typename Order::transposed>{ data_, columns_, rows_, leading_dimension_ };
+		}
+
+	private:
+		size_type lines() const noexcept { return Order::lines(rows_, columns_); }
+		size_type line_size() const noexcept { return Order::line_size(rows_, columns_); }
+
+		pointer data_;
+		size_type rows_, columns_, leading_dimension_;
+	};
+
+	namespace detail
+	{
+		template <class T, class Order, class U, class LeafOrder>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const ConstMatrixView<U, LeafOrder>& operand)
+		{
+			if (destination.size() == 0 || operand.size() == 0)
+			{
+				return false;
+			}
+
+			if (std::is_same<Order, LeafOrder>::value &&
+				static_cast<const void*>(operand.data()) == static_cast<const void*>(destination.data()) &&
+				operand.leading_dimension() == destination.leading_dimension())
+			{
+				return false;
+			}
+
+			return views_overlap(destination.data(), view_storage_end(destination), operand.data(), view_storage_end(operand));
+		}
+
+		template <class T, class Order, class U, class LeafOrder>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const MatrixView<U, LeafOrder>& operand)
+		{
+			return expression_aliases(destination, ConstMatrixView<U, LeafOrder>{ operand });
+		}
+
+		template <class T, class Order, class U, class Alloc, class LeafOrder>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const DMatrix<U, Alloc, LeafOrder>& operand)
+		{
+			return expression_aliases(destination, operand.view());
+		}
+
+		template <class T, class Order, class Lhs, class Rhs, class Operation>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const MatrixBinaryExpression<Lhs, Rhs, Operation>& expression)
+		{
+			return expression_aliases(destination, expression.lhs()) || expression_aliases(destination, expression.rhs());
+		}
+
+		template <class T, class Order, class Expression, class Operation>
+		bool expression_aliases(const ConstMatrixView<T, Order>& destination, const MatrixScalarExpression<Expression, Operation>& expression)
+		{
+			return expression_aliases(destination, expression.expression());
+		}
+	}
+}
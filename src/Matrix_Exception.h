@@ -94,7 +94,8 @@ namespace PrimMatrix
 		{
 			addition,
 			subtraction,
-			multiplication
+			multiplication,
+			assignment
 		};
 
 		explicit Matrix_OperationMatrixMismatch(const EOperation operation, const size_t lhs_rows, const size_t lhs_columns, const size_t rhs_rows, const size_t rhs_columns) :
@@ -119,6 +120,52 @@ namespace PrimMatrix
 		const size_t lhs_rows_, lhs_columns_, rhs_rows_, rhs_columns_;
 	};
 
+	class Matrix_Singular : public Matrix_Exception
+	{
+	public:
+		explicit Matrix_Singular() :
+			Matrix_Exception{ "Matrix is singular and cannot be inverted" }
+		{
+
+		}
+	};
+
+	class Matrix_BatchSizeMismatch : public Matrix_Exception
+	{
+	public:
+		explicit Matrix_BatchSizeMismatch(const size_t lhs_size, const size_t rhs_size) :
+			Matrix_Exception{ "Batches combined by an operation hold different numbers of matrices" },
+			lhs_size_{ lhs_size },
+			rhs_size_{ rhs_size }
+		{
+
+		}
+
+		size_t lhs_size() const noexcept { return lhs_size_; }
+		size_t rhs_size() const noexcept { return rhs_size_; }
+
+	private:
+		const size_t lhs_size_, rhs_size_;
+	};
+
+	class Matrix_InvalidDependency : public Matrix_Exception
+	{
+	public:
+		explicit Matrix_InvalidDependency(const size_t task, const size_t prerequisite) :
+			Matrix_Exception{ "A task can only depend on an existing task added before it" },
+			task_{ task },
+			prerequisite_{ prerequisite }
+		{
+
+		}
+
+		size_t task() const noexcept { return task_; }
+		size_t prerequisite() const noexcept { return prerequisite_; }
+
+	private:
+		const size_t task_, prerequisite_;
+	};
+
 	class Matrix_SpliceOutOfBounds : public Matrix_Exception
 	{
 	public:
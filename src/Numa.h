@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+namespace PrimMatrix
+{
+	// Where the pages of large matrices end up:
+	// local - wherever the constructing thread touches them first, all on its node
+	// first_touch - large matrices are initialized by the pool in the chunks its parallel operations later use, and
+	//               the pool keeps its threads on nodes, so each node holds the share of the data its threads work on
+	// interleave - pages of large matrices are spread round-robin over all nodes, initialized as with first_touch
+	enum class ENumaPolicy
+	{
+		local,
+		first_touch,
+		interleave
+	};
+
+	// NUMA nodes and their CPUs as reported by /sys/devices/system/node, a single node with every CPU elsewhere
+	class NumaTopology
+	{
+	public:
+		static const NumaTopology& system()
+		{
+			static const NumaTopology topology{};
+			return topology;
+		}
+
+		size_t node_count() const noexcept { return nodes_.size(); }
+		size_t node_id(const size_t node) const noexcept { return nodes_[node].id; }
+		const std::vector<size_t>& cpus(const size_t node) const noexcept { return nodes_[node].cpus; }
+
+		// Node of the index-th of count threads when the threads are split over the nodes in contiguous groups
+		size_t node_of_thread(const size_t index, const size_t count) const noexcept
+		{
+			return std::min(index * node_count() / std::max<size_t>(count, 1), node_count() - 1);
+		}
+
+	private:
+		struct Node
+		{
+			size_t id;
+			std::vector<size_t> cpus;
+		};
+
+		NumaTopology()
+		{
+#if defined(__linux__)
+			for (const size_t id : read_list("/sys/devices/system/node/online"))
+			{
+				std::vector<size_t> cpus = read_list("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+				if (!cpus.empty())
+				{
+					nodes_.push_back(Node{ id, std::move(cpus) });
+				}
+			}
+#endif
+			if (nodes_.empty())
+			{
+				Node node{ 0, {} };
+				for (size_t cpu = 0; cpu < std::max<size_t>(std::thread::hardware_concurrency(), 1); ++cpu)
+				{
+					node.cpus.push_back(cpu);
+				}
+
+				nodes_.push_back(std::move(node));
+			}
+		}
+
+		// Parses the kernel's list format, e.g. "0-3,8,10-11"
+		static std::vector<size_t> read_list(const std::string& path)
+		{
+			std::vector<size_t> values;
+			std::ifstream file{ path };
+			std::string list;
+			if (!std::getline(file, list))
+			{
+				return values;
+			}
+
+			size_t position = 0;
+			while (position < list.size())
+			{
+				size_t end = list.find(',', position);
+				if (end == std::string::npos)
+				{
+					end = list.size();
+				}
+
+				const std::string range = list.substr(position, end - position);
+				const size_t dash = range.find('-');
+				try
+				{
+					const size_t first = std::stoul(range.substr(0, dash));
+					const size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+					for (size_t value = first; value <= last; ++value)
+					{
+						values.push_back(value);
+					}
+				}
+				catch (...)
+				{
+					// Malformed entries are skipped, the topology is only a placement hint
+				}
+
+				position = end + 1;
+			}
+
+			return values;
+		}
+
+		std::vector<Node> nodes_;
+	};
+
+	namespace detail
+	{
+		// Page granularity of the placement, the chunks of a parallel initialization start on these boundaries
+		constexpr size_t numa_page_size = 4 * 1024;
+
+		inline std::atomic<ENumaPolicy>& numa_policy_storage() noexcept
+		{
+			static std::atomic<ENumaPolicy> policy{ NumaTopology::system().node_count() > 1 ? ENumaPolicy::first_touch : ENumaPolicy::local };
+			return policy;
+		}
+
+		// Asks the kernel to spread the pages of [memory, memory + size) over all nodes as they are first touched.
+		// Only whole pages inside the range are affected; false when that is not possible here
+		inline bool numa_interleave(void* memory, const size_t size) noexcept
+		{
+#if defined(__linux__) && defined(SYS_mbind)
+			constexpr int mpol_interleave = 3;
+			const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			const size_t begin = (reinterpret_cast<size_t>(memory) + page - 1) / page * page;
+			const size_t end = (reinterpret_cast<size_t>(memory) + size) / page * page;
+			if (begin >= end)
+			{
+				return false;
+			}
+
+			const NumaTopology& topology = NumaTopology::system();
+			size_t max_node = 0;
+			for (size_t node = 0; node < topology.node_count(); ++node)
+			{
+				max_node = std::max(max_node, topology.node_id(node));
+			}
+
+			constexpr size_t bits = sizeof(unsigned long) * CHAR_BIT;
+			std::vector<unsigned long> mask(max_node / bits + 1, 0);
+			for (size_t node = 0; node < topology.node_count(); ++node)
+			{
+				mask[topology.node_id(node) / bits] |= 1ul << (topology.node_id(node) % bits);
+			}
+
+			// The kernel reads one bit less than it is told
+			return syscall(SYS_mbind, begin, end - begin, mpol_interleave, mask.data(), mask.size() * bits + 1, 0) == 0;
+#else
+			(void)memory;
+			(void)size;
+			return false;
+#endif
+		}
+	}
+
+	inline ENumaPolicy numa_policy() noexcept
+	{
+		return detail::numa_policy_storage().load(std::memory_order_relaxed);
+	}
+
+	// Applies to matrices constructed afterwards; the thread placement of the ThreadPool follows on its next resize.
+	// Defaults to first_touch on machines with several nodes and to local elsewhere
+	inline void set_numa_policy(const ENumaPolicy policy) noexcept
+	{
+		detail::numa_policy_storage().store(policy, std::memory_order_relaxed);
+	}
+}
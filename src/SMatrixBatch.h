@@ -0,0 +1,682 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Allocator.h"
+#include "Kernels.h"
+#include "Matrix_Exception.h"
+#include "SMatrix.h"
+#include "StorageOrder.h"
+#include "ThreadPool.h"
+#include "Transpose.h"
+
+namespace PrimMatrix
+{
+	namespace detail
+	{
+		// Below this many multiply-adds a batch stays on the calling thread
+		constexpr size_t batch_parallel_threshold = 1 << 20;
+
+		// Copies matrix l of the group into lane l of the interleaved block. For row-major matrices that is a lanes x size
+		// transpose of the array, which the transpose kernels do in registers
+		template <class T, size_t Rows, size_t Columns, class Order>
+		void batch_interleave(const SMatrix<T, Rows, Columns, Order>* matrices, const size_t lanes, T* interleaved)
+		{
+			static_assert(sizeof(SMatrix<T, Rows, Columns, Order>) == sizeof(T) * Rows * Columns, "SMatrix arrays have to be dense");
+
+			if (Order::row_major)
+			{
+				transpose_tile(selected_transpose_kernel<T>(), lanes, Rows * Columns, matrices->data(), Rows * Columns, interleaved, lanes);
+				return;
+			}
+
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				const SMatrix<T, Rows, Columns, Order>& matrix = matrices[lane];
+				for (size_t row = 0; row < Rows; ++row)
+				{
+					for (size_t column = 0; column < Columns; ++column)
+					{
+						interleaved[(row * Columns + column) * lanes + lane] = matrix(row, column);
+					}
+				}
+			}
+		}
+
+		template <class T, size_t Rows, size_t Columns, class Order>
+		void batch_deinterleave(const T* interleaved, const size_t lanes, SMatrix<T, Rows, Columns, Order>* matrices)
+		{
+			if (Order::row_major)
+			{
+				transpose_tile(selected_transpose_kernel<T>(), Rows * Columns, lanes, interleaved, lanes, matrices->data(), Rows * Columns);
+				return;
+			}
+
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				SMatrix<T, Rows, Columns, Order>& matrix = matrices[lane];
+				for (size_t row = 0; row < Rows; ++row)
+				{
+					for (size_t column = 0; column < Columns; ++column)
+					{
+						matrix(row, column) = interleaved[(row * Columns + column) * lanes + lane];
+					}
+				}
+			}
+		}
+	}
+
+	// out[i] = lhs[i] * rhs[i] for i in [0, count). Groups of as many matrices as a vector register has lanes are
+	// interleaved so that every lane computes its own product, which keeps the FMA units busy on shapes far too
+	// small to vectorize on their own. Shapes that fill whole registers (float 4x4) are multiplied where they lie
+	// instead, converting those costs as much as multiplying them. out may alias lhs or rhs element for element
+	template <class T, size_t Rows, size_t Common, size_t Columns, class LhsOrder, class RhsOrder>
+	void batch_multiply(
+		const SMatrix<T, Rows, Common, LhsOrder>* lhs,
+		const SMatrix<T, Common, Columns, RhsOrder>* rhs,
+		SMatrix<T, Rows, Columns, LhsOrder>* out,
+		const size_t count)
+	{
+		ThreadPool& pool = ThreadPool::instance();
+		const bool parallel = pool.concurrency() > 1 && count * Rows * Common * Columns >= detail::batch_parallel_threshold;
+
+		// Column-major matrices hold the transposes, and (A * B)^T = B^T * A^T
+		const detail::batch_multiply_dense_kernel<T> dense = LhsOrder::row_major ?
+			detail::selected_batch_multiply_dense_kernel<T, Rows, Common, Columns>() :
+			detail::selected_batch_multiply_dense_kernel<T, Columns, Common, Rows>();
+		if (dense && std::is_same<LhsOrder, RhsOrder>::value)
+		{
+			const auto multiply_dense = [&](const size_t begin, const size_t end)
+			{
+				const T* const first = LhsOrder::row_major ? lhs[begin].data() : rhs[begin].data();
+				const T* const second = LhsOrder::row_major ? rhs[begin].data() : lhs[begin].data();
+				dense(first, second, out[begin].data(), end - begin);
+			};
+
+			if (parallel)
+			{
+				pool.parallel_for(0, count, std::max<size_t>(detail::batch_parallel_threshold / 16 / (Rows * Common * Columns), 1), multiply_dense);
+			}
+			else if (count != 0)
+			{
+				multiply_dense(0, count);
+			}
+
+			return;
+		}
+
+		const detail::BatchMultiplyKernel<T>& kernel = detail::selected_batch_multiply_kernel<T, Rows, Common, Columns>();
+		const size_t lanes = kernel.lanes;
+		const size_t groups = count / lanes;
+
+		const auto multiply_groups = [&](const size_t group_begin, const size_t group_end)
+		{
+			std::vector<T> interleaved((Rows * Common + Common * Columns + Rows * Columns) * lanes);
+			T* const lhs_lanes = interleaved.data();
+			T* const rhs_lanes = lhs_lanes + Rows * Common * lanes;
+			T* const out_lanes = rhs_lanes + Common * Columns * lanes;
+
+			for (size_t group = group_begin; group < group_end; ++group)
+			{
+				const size_t first = group * lanes;
+				detail::batch_interleave(lhs + first, lanes, lhs_lanes);
+				detail::batch_interleave(rhs + first, lanes, rhs_lanes);
+				kernel.kernel(lhs_lanes, rhs_lanes, out_lanes, lanes);
+				detail::batch_deinterleave(out_lanes, lanes, out + first);
+			}
+		};
+
+		if (parallel)
+		{
+			const size_t grain = std::max<size_t>(detail::batch_parallel_threshold / 16 / (lanes * Rows * Common * Columns), 1);
+			pool.parallel_for(0, groups, grain, multiply_groups);
+		}
+		else
+		{
+			multiply_groups(0, groups);
+		}
+
+		// The tail is shorter than a register
+		for (size_t i = groups * lanes; i < count; ++i)
+		{
+			out[i] = lhs[i] * rhs[i];
+		}
+	}
+
+	/* STRUCTURE-OF-ARRAYS BATCH */
+
+	namespace detail
+	{
+		// Element arrays hold whole groups of the widest batch kernel, start on cache lines and are not a multiple
+		// of 512 bytes apart, so the Rows * Columns streams a kernel walks do not share cache sets
+		template <class T>
+		size_t batch_stride(const size_t count)
+		{
+			return padded_leading_dimension<T>((count + batch_max_lanes - 1) / batch_max_lanes * batch_max_lanes);
+		}
+
+		inline void check_batch_sizes(const size_t lhs_size, const size_t rhs_size)
+		{
+			if (lhs_size != rhs_size)
+			{
+				throw Matrix_BatchSizeMismatch{ lhs_size, rhs_size };
+			}
+		}
+	}
+
+	// Refers to one matrix of an SMatrixBatch and reads like an SMatrix; every access goes straight to the element
+	// arrays. Copies of a reference refer to the same matrix, assigning to a reference copies the values
+	template <class T, size_t Rows, size_t Columns, class Order>
+	class SMatrixBatchReference
+	{
+	public:
+		using value_type = typename std::remove_const<T>::type;
+		using order_type = Order;
+		using size_type = size_t;
+		using reference = T&;
+		using matrix_type = SMatrix<value_type, Rows, Columns, Order>;
+
+		SMatrixBatchReference(T* first, const size_type stride) noexcept :
+			first_{ first },
+			stride_{ stride }
+		{
+
+		}
+
+		SMatrixBatchReference(const SMatrixBatchReference&) = default;
+
+		// A reference to a mutable matrix converts to one to a const matrix
+		template <class U, class = typename std::enable_if<std::is_same<const U, T>::value && !std::is_same<U, T>::value>::type>
+		SMatrixBatchReference(const SMatrixBatchReference<U, Rows, Columns, Order>& other) noexcept :
+			first_{ other.data() },
+			stride_{ other.stride() }
+		{
+
+		}
+
+		SMatrixBatchReference& operator=(const SMatrixBatchReference& rhs)
+		{
+			for (size_type index = 0; index < size(); ++index)
+			{
+				(*this)[index] = rhs[index];
+			}
+
+			return *this;
+		}
+
+		template <class MatrixOrder>
+		SMatrixBatchReference& operator=(const SMatrix<value_type, Rows, Columns, MatrixOrder>& rhs)
+		{
+			for (size_type row = 0; row < Rows; ++row)
+			{
+				for (size_type column = 0; column < Columns; ++column)
+				{
+					(*this)(row, column) = rhs(row, column);
+				}
+			}
+
+			return *this;
+		}
+
+		constexpr size_type rows() const noexcept { return Rows; }
+		constexpr size_type columns() const noexcept { return Columns; }
+		constexpr size_type size() const noexcept { return Rows * Columns; }
+
+		// The first element of the matrix; the next one in storage order is stride() further
+		T* data() const noexcept { return first_; }
+		size_type stride() const noexcept { return stride_; }
+
+		// Storage order index, as for SMatrix
+		reference operator[](const size_type index) const noexcept
+		{
+			return first_[index * stride_];
+		}
+
+		reference operator()(const size_type row, const size_type column) const noexcept
+		{
+			return (*this)[Order::offset(row, column, Order::line_size(Rows, Columns))];
+		}
+
+		template <class MatrixOrder = Order>
+		SMatrix<value_type, Rows, Columns, MatrixOrder> matrix() const
+		{
+			SMatrix<value_type, Rows, Columns, MatrixOrder> result_matrix{};
+			for (size_type row = 0; row < Rows; ++row)
+			{
+				for (size_type column = 0; column < Columns; ++column)
+				{
+					result_matrix(row, column) = (*this)(row, column);
+				}
+			}
+
+			return result_matrix;
+		}
+
+		operator matrix_type() const
+		{
+			return matrix();
+		}
+
+	private:
+		T* first_;
+		size_type stride_;
+	};
+
+	// Stores `size` Rows x Columns matrices as structure of arrays: element e (in Order) of every matrix is one
+	// contiguous, cache line aligned array, so an operation applied to the whole batch runs across full vector
+	// registers and reading one element of every matrix is a sequential scan. The arrays are stride() apart
+	template <class T, size_t Rows, size_t Columns, class Order = RowMajor, class Alloc = AlignedAllocator<T>>
+	class SMatrixBatch
+	{
+		static_assert(Rows * Columns != 0, "Empty matrices are not supported at the moment");
+
+		using storage_type = std::vector<T, detail::DefaultInitAllocator<Alloc>>;
+
+	public:
+		using value_type = T;
+		using allocator_type = Alloc;
+		using order_type = Order;
+		using size_type = typename storage_type::size_type;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using matrix_type = SMatrix<T, Rows, Columns, Order>;
+		using reference = SMatrixBatchReference<T, Rows, Columns, Order>;
+		using const_reference = SMatrixBatchReference<const T, Rows, Columns, Order>;
+
+		/* CONSTRUCTION || DESTRUCTION */
+		explicit SMatrixBatch(const size_type count = 0, const allocator_type& allocator = allocator_type{}) :
+			size_{ count },
+			stride_{ detail::batch_stride<value_type>(count) },
+			data_(Rows * Columns * stride_, value_type{}, allocator)
+		{
+
+		}
+
+		// The matrices are left uninitialized, the padding after them is zeroed so the batch kernels never see garbage
+		explicit SMatrixBatch(const size_type count, uninitialized_t, const allocator_type& allocator = allocator_type{}) :
+			size_{ count },
+			stride_{ detail::batch_stride<value_type>(count) },
+			data_(Rows * Columns * stride_, allocator)
+		{
+			for (size_type element = 0; element < Rows * Columns; ++element)
+			{
+				std::fill(element_data(element) + size_, element_data(element) + stride_, value_type{});
+			}
+		}
+
+		// Gathers count matrices stored one after another (array of structures)
+		template <class MatrixOrder>
+		explicit SMatrixBatch(const SMatrix<T, Rows, Columns, MatrixOrder>* matrices, const size_type count, const allocator_type& allocator = allocator_type{}) :
+			SMatrixBatch(count, uninitialized, allocator)
+		{
+			assign(matrices);
+		}
+
+		/* DATA ACCESS */
+		size_type size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+		constexpr size_type rows() const noexcept { return Rows; }
+		constexpr size_type columns() const noexcept { return Columns; }
+
+		// Elements between the starts of two element arrays, at least size()
+		size_type stride() const noexcept { return stride_; }
+
+		allocator_type get_allocator() const { return data_.get_allocator(); }
+
+		// All element arrays back to back, Rows * Columns * stride() values
+		pointer data() noexcept { return data_.data(); }
+		const_pointer data() const noexcept { return data_.data(); }
+
+		// Element `index` (in Order) or (row, column) of every matrix
+		pointer element_data(const size_type index) noexcept { return data() + index * stride_; }
+		const_pointer element_data(const size_type index) const noexcept { return data() + index * stride_; }
+
+		pointer element_data(const size_type row, const size_type column) noexcept
+		{
+			return element_data(Order::offset(row, column, Order::line_size(Rows, Columns)));
+		}
+
+		const_pointer element_data(const size_type row, const size_type column) const noexcept
+		{
+			return element_data(Order::offset(row, column, Order::line_size(Rows, Columns)));
+		}
+
+		reference operator[](const size_type index) noexcept
+		{
+			return { data() + index, stride_ };
+		}
+
+		const_reference operator[](const size_type index) const noexcept
+		{
+			return { data() + index, stride_ };
+		}
+
+		reference at(const size_type index)
+		{
+			if (index >= size())
+			{
+				throw Matrix_IndexOutOfBounds{ index, size() };
+			}
+
+			return (*this)[index];
+		}
+
+		const_reference at(const size_type index) const
+		{
+			if (index >= size())
+			{
+				throw Matrix_IndexOutOfBounds{ index, size() };
+			}
+
+			return (*this)[index];
+		}
+
+		/* CONVERSION */
+
+		// Scatters size() matrices from / to an array of structures. Matrices stored in Order are a size() x
+		// (Rows * Columns) matrix, which the transpose kernels turn into the element arrays a cache tile at a time
+		template <class MatrixOrder>
+		void assign(const SMatrix<T, Rows, Columns, MatrixOrder>* matrices)
+		{
+			static_assert(sizeof(SMatrix<T, Rows, Columns, MatrixOrder>) == sizeof(T) * Rows * Columns, "SMatrix arrays have to be dense");
+
+			if (empty())
+			{
+				return;
+			}
+
+			if (std::is_same<MatrixOrder, Order>::value)
+			{
+				detail::transpose(size_, Rows * Columns, matrices->data(), Rows * Columns, data(), stride_);
+				return;
+			}
+
+			for (size_type index = 0; index < size_; ++index)
+			{
+				(*this)[index] = matrices[index];
+			}
+		}
+
+		template <class MatrixOrder>
+		void copy_to(SMatrix<T, Rows, Columns, MatrixOrder>* matrices) const
+		{
+			static_assert(sizeof(SMatrix<T, Rows, Columns, MatrixOrder>) == sizeof(T) * Rows * Columns, "SMatrix arrays have to be dense");
+
+			if (empty())
+			{
+				return;
+			}
+
+			if (std::is_same<MatrixOrder, Order>::value)
+			{
+				detail::transpose(Rows * Columns, size_, data(), stride_, matrices->data(), Rows * Columns);
+				return;
+			}
+
+			for (size_type index = 0; index < size_; ++index)
+			{
+				matrices[index] = (*this)[index].template matrix<MatrixOrder>();
+			}
+		}
+
+		std::vector<SMatrix<T, Rows, Columns, Order>> to_vector() const
+		{
+			std::vector<SMatrix<T, Rows, Columns, Order>> matrices(size_);
+			copy_to(matrices.data());
+			return matrices;
+		}
+
+		/* OPERATORS */
+		SMatrixBatch& operator+=(const SMatrixBatch& rhs)
+		{
+			detail::check_batch_sizes(size(), rhs.size());
+			detail::selected_elementwise_kernels<value_type>().add(data_.size(), data(), rhs.data(), value_type{}, data());
+			return *this;
+		}
+
+		SMatrixBatch& operator-=(const SMatrixBatch& rhs)
+		{
+			detail::check_batch_sizes(size(), rhs.size());
+			detail::selected_elementwise_kernels<value_type>().subtract(data_.size(), data(), rhs.data(), value_type{}, data());
+			return *this;
+		}
+
+		SMatrixBatch& operator*=(const value_type& rhs)
+		{
+			detail::selected_elementwise_kernels<value_type>().scale(data_.size(), data(), data(), rhs, data());
+			return *this;
+		}
+
+		/* OPERATIONS */
+
+		// Transposing a batch only moves whole element arrays
+		SMatrixBatch<T, Columns, Rows, Order, Alloc> transpose() const
+		{
+			SMatrixBatch<T, Columns, Rows, Order, Alloc> result_batch{ size_, uninitialized, get_allocator() };
+			for (size_type row = 0; row < Rows; ++row)
+			{
+				for (size_type column = 0; column < Columns; ++column)
+				{
+					std::copy(element_data(row, column), element_data(row, column) + stride_, result_batch.element_data(column, row));
+				}
+			}
+
+			return result_batch;
+		}
+
+	private:
+		size_type size_;
+		size_type stride_;
+		storage_type data_;
+	};
+
+	template <class T, size_t Rows, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator+(
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& lhs,
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& rhs)
+	{
+		detail::check_batch_sizes(lhs.size(), rhs.size());
+
+		SMatrixBatch<T, Rows, Columns, Order, Alloc> result_batch{ lhs.size(), uninitialized, lhs.get_allocator() };
+		detail::selected_elementwise_kernels<T>().add(Rows * Columns * lhs.stride(), lhs.data(), rhs.data(), T{}, result_batch.data());
+		return result_batch;
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator-(
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& lhs,
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& rhs)
+	{
+		detail::check_batch_sizes(lhs.size(), rhs.size());
+
+		SMatrixBatch<T, Rows, Columns, Order, Alloc> result_batch{ lhs.size(), uninitialized, lhs.get_allocator() };
+		detail::selected_elementwise_kernels<T>().subtract(Rows * Columns * lhs.stride(), lhs.data(), rhs.data(), T{}, result_batch.data());
+		return result_batch;
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator*(
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& lhs,
+		const T& rhs)
+	{
+		SMatrixBatch<T, Rows, Columns, Order, Alloc> result_batch{ lhs.size(), uninitialized, lhs.get_allocator() };
+		detail::selected_elementwise_kernels<T>().scale(Rows * Columns * lhs.stride(), lhs.data(), lhs.data(), rhs, result_batch.data());
+		return result_batch;
+	}
+
+	// Overloads for expiring batches, the result is computed into the temporary's storage. A batch of millions of
+	// matrices is far larger than the caches, so this saves faulting in a fresh allocation as much as the copy
+	template <class T, size_t Rows, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator+(
+		SMatrixBatch<T, Rows, Columns, Order, Alloc>&& lhs,
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& rhs)
+	{
+		lhs += rhs;
+		return std::move(lhs);
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator-(
+		SMatrixBatch<T, Rows, Columns, Order, Alloc>&& lhs,
+		const SMatrixBatch<T, Rows, Columns, Order, Alloc>& rhs)
+	{
+		lhs -= rhs;
+		return std::move(lhs);
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator*(
+		SMatrixBatch<T, Rows, Columns, Order, Alloc>&& lhs,
+		const T& rhs)
+	{
+		lhs *= rhs;
+		return std::move(lhs);
+	}
+
+	// result[i] = lhs[i] * rhs[i] into an existing batch. The element arrays already are the interleaved layout the
+	// batch kernels work on, so each group of lanes is one kernel call without any packing. result may be lhs or rhs,
+	// the groups are then packed first
+	template <class T, size_t Rows, size_t Common, size_t Columns, class Order, class Alloc>
+	void batch_multiply(
+		const SMatrixBatch<T, Rows, Common, Order, Alloc>& lhs,
+		const SMatrixBatch<T, Common, Columns, Order, Alloc>& rhs,
+		SMatrixBatch<T, Rows, Columns, Order, Alloc>& result)
+	{
+		detail::check_batch_sizes(lhs.size(), rhs.size());
+		detail::check_batch_sizes(lhs.size(), result.size());
+
+		// Column-major element arrays hold the transposes, and (A * B)^T = B^T * A^T
+		const detail::BatchMultiplyKernel<T>& kernel = Order::row_major ?
+			detail::selected_batch_multiply_kernel<T, Rows, Common, Columns>() :
+			detail::selected_batch_multiply_kernel<T, Columns, Common, Rows>();
+		const T* const first = Order::row_major ? lhs.data() : rhs.data();
+		const T* const second = Order::row_major ? rhs.data() : lhs.data();
+		T* const out = result.data();
+		const size_t stride = lhs.stride();
+		const size_t lanes = kernel.lanes;
+		const bool aliased = out == lhs.data() || out == rhs.data();
+
+		// An aliased group is gathered into a packed block first; the kernels take one stride for all three operands
+		const auto copy_group = [&](const T* src, const size_t src_stride, const size_t elements, T* dst, const size_t dst_stride)
+		{
+			for (size_t element = 0; element < elements; ++element)
+			{
+				std::copy(src + element * src_stride, src + element * src_stride + lanes, dst + element * dst_stride);
+			}
+		};
+
+		const auto multiply_groups = [&](const size_t group_begin, const size_t group_end)
+		{
+			T packed[(Rows * Common + Common * Columns + Rows * Columns) * detail::batch_max_lanes];
+			T* const packed_first = packed;
+			T* const packed_second = packed_first + (Order::row_major ? Rows * Common : Common * Columns) * lanes;
+			T* const packed_out = packed + (Rows * Common + Common * Columns) * lanes;
+
+			for (size_t group = group_begin; group < group_end; ++group)
+			{
+				const size_t first_lane = group * lanes;
+				if (!aliased)
+				{
+					kernel.kernel(first + first_lane, second + first_lane, out + first_lane, stride);
+					continue;
+				}
+
+				copy_group(first + first_lane, stride, Order::row_major ? Rows * Common : Common * Columns, packed_first, lanes);
+				copy_group(second + first_lane, stride, Order::row_major ? Common * Columns : Rows * Common, packed_second, lanes);
+				kernel.kernel(packed_first, packed_second, packed_out, lanes);
+				copy_group(packed_out, lanes, Rows * Columns, out + first_lane, stride);
+			}
+		};
+
+		// The stride is a whole number of groups, so the last group reads and writes padding instead of needing a tail
+		const size_t groups = (lhs.size() + lanes - 1) / lanes;
+		ThreadPool& pool = ThreadPool::instance();
+		if (pool.concurrency() > 1 && lhs.size() * Rows * Common * Columns >= detail::batch_parallel_threshold)
+		{
+			const size_t grain = std::max<size_t>(detail::batch_parallel_threshold / 16 / (lanes * Rows * Common * Columns), 1);
+			pool.parallel_for(0, groups, grain, multiply_groups);
+		}
+		else
+		{
+			multiply_groups(0, groups);
+		}
+	}
+
+	template <class T, size_t Rows, size_t Common, size_t Columns, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator*(
+		const SMatrixBatch<T, Rows, Common, Order, Alloc>& lhs,
+		const SMatrixBatch<T, Common, Columns, Order, Alloc>& rhs)
+	{
+		detail::check_batch_sizes(lhs.size(), rhs.size());
+
+		SMatrixBatch<T, Rows, Columns, Order, Alloc> result_batch{ lhs.size(), uninitialized, lhs.get_allocator() };
+		batch_multiply(lhs, rhs, result_batch);
+		return result_batch;
+	}
+
+	namespace detail
+	{
+		// Elements per element array that one pass of a transform covers, so the arrays it reads several
+		// times stay in L1 / L2 instead of being streamed from memory once per entry of the transform
+		constexpr size_t batch_transform_chunk = 512;
+
+		// result(row, column) = sum over p of scalar(row, p, column) * values(row, p, column), where values is an element
+		// array of the batch and scalar the matching entry of the transform; the arrays are combined a chunk at a time
+		template <class T, size_t Rows, size_t Common, size_t Columns, class Scalar, class Values, class Result>
+		void batch_transform(const size_t stride, const Scalar& scalar, const Values& values, const Result& result)
+		{
+			const ElementwiseKernels<T>& elementwise = selected_elementwise_kernels<T>();
+			const GemvKernels<T>& gemv = selected_gemv_kernels<T>();
+
+			for (size_t begin = 0; begin < stride; begin += batch_transform_chunk)
+			{
+				const size_t length = std::min(batch_transform_chunk, stride - begin);
+				for (size_t row = 0; row < Rows; ++row)
+				{
+					for (size_t column = 0; column < Columns; ++column)
+					{
+						T* const out = result(row, column) + begin;
+						const T* const first = values(row, 0, column) + begin;
+						elementwise.scale(length, first, first, scalar(row, 0, column), out);
+						for (size_t p = 1; p < Common; ++p)
+						{
+							gemv.axpy(length, scalar(row, p, column), values(row, p, column) + begin, out);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// One transform applied to every matrix of the batch
+	template <class T, size_t Rows, size_t Common, size_t Columns, class MatrixOrder, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator*(
+		const SMatrix<T, Rows, Common, MatrixOrder>& lhs,
+		const SMatrixBatch<T, Common, Columns, Order, Alloc>& rhs)
+	{
+		SMatrixBatch<T, Rows, Columns, Order, Alloc> result_batch{ rhs.size(), uninitialized, rhs.get_allocator() };
+		detail::batch_transform<T, Rows, Common, Columns>(
+			rhs.stride(),
+			[&](const size_t row, const size_t p, size_t) { return lhs(row, p); },
+			[&](size_t, const size_t p, const size_t column) { return rhs.element_data(p, column); },
+			[&](const size_t row, const size_t column) { return result_batch.element_data(row, column); });
+		return result_batch;
+	}
+
+	template <class T, size_t Rows, size_t Common, size_t Columns, class MatrixOrder, class Order, class Alloc>
+	SMatrixBatch<T, Rows, Columns, Order, Alloc> operator*(
+		const SMatrixBatch<T, Rows, Common, Order, Alloc>& lhs,
+		const SMatrix<T, Common, Columns, MatrixOrder>& rhs)
+	{
+		SMatrixBatch<T, Rows, Columns, Order, Alloc> result_batch{ lhs.size(), uninitialized, lhs.get_allocator() };
+		detail::batch_transform<T, Rows, Common, Columns>(
+			lhs.stride(),
+			[&](size_t, const size_t p, const size_t column) { return rhs(p, column); },
+			[&](const size_t row, const size_t p, size_t) { return lhs.element_data(row, p); },
+			[&](const size_t row, const size_t column) { return result_batch.element_data(row, column); });
+		return result_batch;
+	}
+}
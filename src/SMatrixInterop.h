@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "DMatrix.h"
+#include "Matrix_Exception.h"
+#include "MatrixExpression.h"
+#include "MatrixView.h"
+#include "SMatrix.h"
+#include "StorageOrder.h"
+#include "ThreadPool.h"
+
+namespace PrimMatrix
+{
+	/* SMATRIX AS A VIEW */
+
+	// The SMatrix storage seen as a dynamic view, so it takes part in expressions and GEMM without a copy.
+	// The matrix has to outlive the view
+	template <class T, size_t Rows, size_t Columns, class Order>
+	MatrixView<T, Order> view(SMatrix<T, Rows, Columns, Order>& matrix) noexcept
+	{
+		return MatrixView<T, Order>{ matrix.data(), Rows, Columns };
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order>
+	ConstMatrixView<T, Order> view(const SMatrix<T, Rows, Columns, Order>& matrix) noexcept
+	{
+		return ConstMatrixView<T, Order>{ matrix.data(), Rows, Columns };
+	}
+
+	/* FIXED-SIZE BLOCKS OF DYNAMIC STORAGE */
+
+	// Rows x Columns window on dynamic storage, e.g. a block of a DMatrix, that reads like an SMatrix. T is const for
+	// read-only windows. Copies of a reference refer to the same elements, assigning to a reference writes through
+	template <class T, size_t Rows, size_t Columns, class Order = RowMajor>
+	class SMatrixRef
+	{
+	public:
+		using value_type = typename std::remove_const<T>::type;
+		using order_type = Order;
+		using size_type = size_t;
+		using reference = T&;
+		using pointer = T*;
+		using matrix_type = SMatrix<value_type, Rows, Columns, Order>;
+		using view_type = typename std::conditional<std::is_const<T>::value, ConstMatrixView<value_type, Order>, MatrixView<value_type, Order>>::type;
+
+		explicit SMatrixRef(pointer data, const size_type leading_dimension = Order::line_size(Rows, Columns)) noexcept :
+			data_{ data },
+			leading_dimension_{ leading_dimension }
+		{
+
+		}
+
+		SMatrixRef(const SMatrixRef&) = default;
+
+		// A reference to mutable elements converts to one to const elements
+		template <class U, class = typename std::enable_if<std::is_same<const U, T>::value && !std::is_same<U, T>::value>::type>
+		SMatrixRef(const SMatrixRef<U, Rows, Columns, Order>& other) noexcept :
+			data_{ other.data() },
+			leading_dimension_{ other.leading_dimension() }
+		{
+
+		}
+
+		SMatrixRef& operator=(const SMatrixRef& rhs)
+		{
+			return *this = rhs.matrix();
+		}
+
+		template <class MatrixOrder>
+		SMatrixRef& operator=(const SMatrix<value_type, Rows, Columns, MatrixOrder>& rhs)
+		{
+			detail::for_each_index<Order>(Rows, Columns, [&](const size_type row, const size_type column)
+			{
+				(*this)(row, column) = rhs(row, column);
+			});
+
+			return *this;
+		}
+
+		template <class MatrixOrder>
+		SMatrixRef& operator+=(const SMatrix<value_type, Rows, Columns, MatrixOrder>& rhs)
+		{
+			detail::for_each_index<Order>(Rows, Columns, [&](const size_type row, const size_type column)
+			{
+				(*this)(row, column) += rhs(row, column);
+			});
+
+			return *this;
+		}
+
+		template <class MatrixOrder>
+		SMatrixRef& operator-=(const SMatrix<value_type, Rows, Columns, MatrixOrder>& rhs)
+		{
+			detail::for_each_index<Order>(Rows, Columns, [&](const size_type row, const size_type column)
+			{
+				(*this)(row, column) -= rhs(row, column);
+			});
+
+			return *this;
+		}
+
+		SMatrixRef& operator*=(const value_type& rhs)
+		{
+			detail::for_each_index<Order>(Rows, Columns, [&](const size_type row, const size_type column)
+			{
+				(*this)(row, column) *= rhs;
+			});
+
+			return *this;
+		}
+
+		constexpr size_type rows() const noexcept { return Rows; }
+		constexpr size_type columns() const noexcept { return Columns; }
+		constexpr size_type size() const noexcept { return Rows * Columns; }
+		size_type leading_dimension() const noexcept { return leading_dimension_; }
+
+		pointer data() const noexcept { return data_; }
+
+		reference at(const size_type row, const size_type column) const
+		{
+			if (row >= Rows ||
+				column >= Columns)
+			{
+				throw Matrix_RowColOutOfBounds{ row, column, Rows, Columns };
+			}
+
+			return (*this)(row, column);
+		}
+
+		reference operator()(const size_type row, const size_type column) const noexcept
+		{
+			return data_[Order::offset(row, column, leading_dimension_)];
+		}
+
+		// Copies the elements, in any storage order
+		template <class MatrixOrder = Order>
+		SMatrix<value_type, Rows, Columns, MatrixOrder> matrix() const
+		{
+			SMatrix<value_type, Rows, Columns, MatrixOrder> result_matrix{};
+			detail::for_each_index<MatrixOrder>(Rows, Columns, [&](const size_type row, const size_type column)
+			{
+				result_matrix(row, column) = (*this)(row, column);
+			});
+
+			return result_matrix;
+		}
+
+		operator matrix_type() const
+		{
+			return matrix();
+		}
+
+		view_type view() const noexcept
+		{
+			return view_type{ data_, Rows, Columns, leading_dimension_ };
+		}
+
+	private:
+		pointer data_;
+		size_type leading_dimension_;
+	};
+
+	// The Rows x Columns block starting at (row, column); throws Matrix_SpliceOutOfBounds when it does not fit
+	template <size_t Rows, size_t Columns, class T, class Order>
+	SMatrixRef<T, Rows, Columns, Order> block(const MatrixView<T, Order>& view, const size_t row, const size_t column)
+	{
+		detail::check_view_splice(Splice{ row, column, Rows, Columns }, view.rows(), view.columns());
+		return SMatrixRef<T, Rows, Columns, Order>{ &view(row, column), view.leading_dimension() };
+	}
+
+	template <size_t Rows, size_t Columns, class T, class Order>
+	SMatrixRef<const T, Rows, Columns, Order> block(const ConstMatrixView<T, Order>& view, const size_t row, const size_t column)
+	{
+		detail::check_view_splice(Splice{ row, column, Rows, Columns }, view.rows(), view.columns());
+		return SMatrixRef<const T, Rows, Columns, Order>{ &view(row, column), view.leading_dimension() };
+	}
+
+	template <size_t Rows, size_t Columns, class T, class Alloc, class Order>
+	SMatrixRef<T, Rows, Columns, Order> block(DMatrix<T, Alloc, Order>& matrix, const size_t row, const size_t column)
+	{
+		return block<Rows, Columns>(matrix.view(), row, column);
+	}
+
+	template <size_t Rows, size_t Columns, class T, class Alloc, class Order>
+	SMatrixRef<const T, Rows, Columns, Order> block(const DMatrix<T, Alloc, Order>& matrix, const size_t row, const size_t column)
+	{
+		return block<Rows, Columns>(matrix.view(), row, column);
+	}
+
+	/* MIXED ARITHMETIC */
+
+	// Fixed-size operands keep a fixed-size result: references are read into an SMatrix in the other operand's order
+
+	template <class T, class U, size_t Rows, size_t Columns, class RefOrder, class Order>
+	SMatrix<T, Rows, Columns, Order> operator+(const SMatrixRef<U, Rows, Columns, RefOrder>& lhs, const SMatrix<T, Rows, Columns, Order>& rhs)
+	{
+		return lhs.template matrix<Order>() + rhs;
+	}
+
+	template <class T, class U, size_t Rows, size_t Columns, class Order, class RefOrder>
+	SMatrix<T, Rows, Columns, Order> operator+(const SMatrix<T, Rows, Columns, Order>& lhs, const SMatrixRef<U, Rows, Columns, RefOrder>& rhs)
+	{
+		return lhs + rhs.template matrix<Order>();
+	}
+
+	template <class T, class U, size_t Rows, size_t Columns, class LhsOrder, class RhsOrder>
+	SMatrix<typename std::remove_const<T>::type, Rows, Columns, LhsOrder> operator+(
+		const SMatrixRef<T, Rows, Columns, LhsOrder>& lhs,
+		const SMatrixRef<U, Rows, Columns, RhsOrder>& rhs)
+	{
+		return lhs.matrix() + rhs.template matrix<LhsOrder>();
+	}
+
+	template <class T, class U, size_t Rows, size_t Columns, class RefOrder, class Order>
+	SMatrix<T, Rows, Columns, Order> operator-(const SMatrixRef<U, Rows, Columns, RefOrder>& lhs, const SMatrix<T, Rows, Columns, Order>& rhs)
+	{
+		return lhs.template matrix<Order>() - rhs;
+	}
+
+	template <class T, class U, size_t Rows, size_t Columns, class Order, class RefOrder>
+	SMatrix<T, Rows, Columns, Order> operator-(const SMatrix<T, Rows, Columns, Order>& lhs, const SMatrixRef<U, Rows, Columns, RefOrder>& rhs)
+	{
+		return lhs - rhs.template matrix<Order>();
+	}
+
+	template <class T, class U, size_t Rows, size_t Columns, class LhsOrder, class RhsOrder>
+	SMatrix<typename std::remove_const<T>::type, Rows, Columns, LhsOrder> operator-(
+		const SMatrixRef<T, Rows, Columns, LhsOrder>& lhs,
+		const SMatrixRef<U, Rows, Columns, RhsOrder>& rhs)
+	{
+		return lhs.matrix() - rhs.template matrix<LhsOrder>();
+	}
+
+	template <class T, class U, size_t Rows, size_t Common, size_t Columns, class RefOrder, class Order>
+	SMatrix<T, Rows, Columns, RefOrder> operator*(const SMatrixRef<U, Rows, Common, RefOrder>& lhs, const SMatrix<T, Common, Columns, Order>& rhs)
+	{
+		return lhs.matrix() * rhs;
+	}
+
+	template <class T, class U, size_t Rows, size_t Common, size_t Columns, class Order, class RefOrder>
+	SMatrix<T, Rows, Columns, Order> operator*(const SMatrix<T, Rows, Common, Order>& lhs, const SMatrixRef<U, Common, Columns, RefOrder>& rhs)
+	{
+		return lhs * rhs.matrix();
+	}
+
+	template <class T, class U, size_t Rows, size_t Common, size_t Columns, class LhsOrder, class RhsOrder>
+	SMatrix<typename std::remove_const<T>::type, Rows, Columns, LhsOrder> operator*(
+		const SMatrixRef<T, Rows, Common, LhsOrder>& lhs,
+		const SMatrixRef<U, Common, Columns, RhsOrder>& rhs)
+	{
+		return lhs.matrix() * rhs.matrix();
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order>
+	SMatrix<typename std::remove_const<T>::type, Rows, Columns, Order> operator*(
+		const SMatrixRef<T, Rows, Columns, Order>& lhs,
+		const typename std::remove_const<T>::type& rhs)
+	{
+		return lhs.matrix() * rhs;
+	}
+
+	namespace detail
+	{
+		template <class Fixed, class Lhs, class Rhs, class Operation>
+		Fixed fixed_elementwise(const Lhs& lhs, const Rhs& rhs, Operation)
+		{
+			if (lhs.rows() != rhs.rows() ||
+				lhs.columns() != rhs.columns())
+			{
+				throw Matrix_OperationMatrixMismatch {
+					Operation::operation,
+					lhs.rows(),
+					lhs.columns(),
+					rhs.rows(),
+					rhs.columns() };
+			}
+
+			Fixed result_matrix{};
+			for_each_index<typename Fixed::order_type>(result_matrix.rows(), result_matrix.columns(), [&](const size_t row, const size_t column)
+			{
+				result_matrix(row, column) = Operation::apply(lhs(row, column), rhs(row, column));
+			});
+
+			return result_matrix;
+		}
+	}
+
+	// An SMatrix and a dynamic expression of the same size give an SMatrix; the size is checked at run time
+	template <class T, size_t Rows, size_t Columns, class Order, class Rhs>
+	SMatrix<T, Rows, Columns, Order> operator+(const SMatrix<T, Rows, Columns, Order>& lhs, const MatrixExpression<Rhs>& rhs)
+	{
+		return detail::fixed_elementwise<SMatrix<T, Rows, Columns, Order>>(lhs, rhs.derived(), detail::AddOperation{});
+	}
+
+	template <class Lhs, class T, size_t Rows, size_t Columns, class Order>
+	SMatrix<T, Rows, Columns, Order> operator+(const MatrixExpression<Lhs>& lhs, const SMatrix<T, Rows, Columns, Order>& rhs)
+	{
+		return detail::fixed_elementwise<SMatrix<T, Rows, Columns, Order>>(lhs.derived(), rhs, detail::AddOperation{});
+	}
+
+	template <class T, size_t Rows, size_t Columns, class Order, class Rhs>
+	SMatrix<T, Rows, Columns, Order> operator-(const SMatrix<T, Rows, Columns, Order>& lhs, const MatrixExpression<Rhs>& rhs)
+	{
+		return detail::fixed_elementwise<SMatrix<T, Rows, Columns, Order>>(lhs, rhs.derived(), detail::SubtractOperation{});
+	}
+
+	template <class Lhs, class T, size_t Rows, size_t Columns, class Order>
+	SMatrix<T, Rows, Columns, Order> operator-(const MatrixExpression<Lhs>& lhs, const SMatrix<T, Rows, Columns, Order>& rhs)
+	{
+		return detail::fixed_elementwise<SMatrix<T, Rows, Columns, Order>>(lhs.derived(), rhs, detail::SubtractOperation{});
+	}
+
+	namespace detail
+	{
+		// Fixed sides up to this many elements are multiplied a row (or column) of the dynamic side at a time with the
+		// unrolled SMatrix kernels; packing such shapes for GEMM, e.g. N x 3 points times a 3x3 or 4x4 transform,
+		// costs more than the whole product
+		constexpr size_t fixed_product_max_elements = 8 * 8;
+
+		// Below this many multiply-adds a row-by-row product stays on the calling thread
+		constexpr size_t fixed_product_parallel_threshold = 256 * 1024;
+
+		template <class Function>
+		void fixed_product_lines(const size_t lines, const size_t line_work, const Function& function)
+		{
+			ThreadPool& pool = ThreadPool::instance();
+			if (pool.concurrency() > 1 && lines * line_work >= fixed_product_parallel_threshold)
+			{
+				pool.parallel_for(0, lines, std::max<size_t>(fixed_product_parallel_threshold / 16 / line_work, 1), function);
+			}
+			else
+			{
+				function(0, lines);
+			}
+		}
+
+		// result = lhs * rhs, row i of the result being row i of lhs times rhs
+		template <class Lhs, class T, size_t Common, size_t Columns, class Order, class Result>
+		void fixed_rhs_product(const Lhs& lhs, const SMatrix<T, Common, Columns, Order>& rhs, const Result& result)
+		{
+			fixed_product_lines(lhs.rows(), Common * Columns, [&](const size_t row_begin, const size_t row_end)
+			{
+				for (size_t row = row_begin; row < row_end; ++row)
+				{
+					SMatrix<T, 1, Common, Order> lhs_row{};
+					for (size_t p = 0; p < Common; ++p)
+					{
+						lhs_row(0, p) = lhs(row, p);
+					}
+
+					const SMatrix<T, 1, Columns, Order> result_row = lhs_row * rhs;
+					for (size_t column = 0; column < Columns; ++column)
+					{
+						result(row, column) = result_row(0, column);
+					}
+				}
+			});
+		}
+
+		// result = lhs * rhs, column j of the result being lhs times column j of rhs
+		template <class T, size_t Rows, size_t Common, class Order, class Rhs, class Result>
+		void fixed_lhs_product(const SMatrix<T, Rows, Common, Order>& lhs, const Rhs& rhs, const Result& result)
+		{
+			fixed_product_lines(rhs.columns(), Rows * Common, [&](const size_t column_begin, const size_t column_end)
+			{
+				for (size_t column = column_begin; column < column_end; ++column)
+				{
+					SMatrix<T, Common, 1, Order> rhs_column{};
+					for (size_t p = 0; p < Common; ++p)
+					{
+						rhs_column(p, 0) = rhs(p, column);
+					}
+
+					const SMatrix<T, Rows, 1, Order> result_column = lhs * rhs_column;
+					for (size_t row = 0; row < Rows; ++row)
+					{
+						result(row, column) = result_column(row, 0);
+					}
+				}
+			});
+		}
+	}
+
+	// Products with a dynamic side have a dynamic dimension. Small fixed sides walk the dynamic side with the unrolled
+	// SMatrix kernels, larger ones run on the GEMM engine straight from the SMatrix storage. The result keeps the
+	// storage order both operands share and is row-major otherwise, like products of two dynamic operands
+	template <class T, size_t Rows, size_t Columns, class Order, class Rhs>
+	auto operator*(const SMatrix<T, Rows, Columns, Order>& lhs, const MatrixExpression<Rhs>& rhs)
+	{
+		if (Rows * Columns > detail::fixed_product_max_elements)
+		{
+			return view(lhs) * rhs;
+		}
+
+		const auto& rhs_operand = detail::product_operand(rhs.derived());
+		detail::check_product(view(lhs), rhs_operand);
+
+		using rhs_order = typename std::decay<decltype(rhs_operand)>::type::order_type;
+		using result_order = typename std::conditional<std::is_same<Order, rhs_order>::value, Order, RowMajor>::type;
+		DMatrix<T, std::allocator<T>, result_order> result_matrix{ Rows, rhs_operand.columns(), uninitialized };
+		detail::fixed_lhs_product(lhs, rhs_operand.view(), result_matrix.view());
+
+		return result_matrix;
+	}
+
+	template <class Lhs, class T, size_t Rows, size_t Columns, class Order>
+	auto operator*(const MatrixExpression<Lhs>& lhs, const SMatrix<T, Rows, Columns, Order>& rhs)
+	{
+		if (Rows * Columns > detail::fixed_product_max_elements)
+		{
+			return lhs * view(rhs);
+		}
+
+		const auto& lhs_operand = detail::product_operand(lhs.derived());
+		detail::check_product(lhs_operand, view(rhs));
+
+		using lhs_order = typename std::decay<decltype(lhs_operand)>::type::order_type;
+		using result_order = typename std::conditional<std::is_same<lhs_order, Order>::value, lhs_order, RowMajor>::type;
+		DMatrix<T, std::allocator<T>, result_order> result_matrix{ lhs_operand.rows(), Columns, uninitialized };
+		detail::fixed_rhs_product(lhs_operand.view(), rhs, result_matrix.view());
+
+		return result_matrix;
+	}
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PRIM_MATRIX_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define PRIM_MATRIX_SSE2 0
+#endif
+
+#if defined(__clang__)
+	#if defined(__has_builtin)
+		#if __has_builtin(__builtin_is_constant_evaluated)
+			#define PRIM_MATRIX_HAS_CONSTANT_EVALUATED 1
+		#endif
+	#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+	#define PRIM_MATRIX_HAS_CONSTANT_EVALUATED 1
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+	#define PRIM_MATRIX_HAS_CONSTANT_EVALUATED 1
+#endif
+
+#ifndef PRIM_MATRIX_HAS_CONSTANT_EVALUATED
+	#define PRIM_MATRIX_HAS_CONSTANT_EVALUATED 0
+#endif
+
+namespace PrimMatrix
+{
+	namespace detail
+	{
+		// True while the compiler evaluates a constant expression; without the builtin every call counts as one,
+		// so SMatrix stays on its constexpr loops
+		constexpr bool constant_evaluated() noexcept
+		{
+#if PRIM_MATRIX_HAS_CONSTANT_EVALUATED
+			return __builtin_is_constant_evaluated();
+#else
+			return true;
+#endif
+		}
+
+		// SSE2 kernels for square N x N matrices stored line by line. Storage order does not matter to add, subtract and
+		// transpose; multiply computes row-major products, column-major ones are the same product with swapped operands.
+		// Only the specializations below are enabled, everything else stays on the generic loops
+		template <class T, size_t N>
+		struct SMatrixSimd
+		{
+			static constexpr bool enabled = false;
+
+			static void multiply(const T*, const T*, T*) noexcept {}
+			static void add(const T*, const T*, T*) noexcept {}
+			static void subtract(const T*, const T*, T*) noexcept {}
+			static void transpose(const T*, T*) noexcept {}
+		};
+
+#if PRIM_MATRIX_SSE2
+		// Element-wise add and subtract on whole registers plus a scalar tail, shared by all the shapes
+		template <size_t Size>
+		struct SimdElementwise
+		{
+			static void add(const float* lhs, const float* rhs, float* out) noexcept
+			{
+				constexpr size_t full = Size / 4 * 4;
+
+				size_t i = 0;
+				for (; i < full; i += 4)
+				{
+					_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i)));
+				}
+
+				for (i = full; i < Size; ++i)
+				{
+					out[i] = lhs[i] + rhs[i];
+				}
+			}
+
+			static void subtract(const float* lhs, const float* rhs, float* out) noexcept
+			{
+				constexpr size_t full = Size / 4 * 4;
+
+				size_t i = 0;
+				for (; i < full; i += 4)
+				{
+					_mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i)));
+				}
+
+				for (i = full; i < Size; ++i)
+				{
+					out[i] = lhs[i] - rhs[i];
+				}
+			}
+
+			static void add(const double* lhs, const double* rhs, double* out) noexcept
+			{
+				constexpr size_t full = Size / 2 * 2;
+
+				size_t i = 0;
+				for (; i < full; i += 2)
+				{
+					_mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i)));
+				}
+
+				for (i = full; i < Size; ++i)
+				{
+					out[i] = lhs[i] + rhs[i];
+				}
+			}
+
+			static void subtract(const double* lhs, const double* rhs, double* out) noexcept
+			{
+				constexpr size_t full = Size / 2 * 2;
+
+				size_t i = 0;
+				for (; i < full; i += 2)
+				{
+					_mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i)));
+				}
+
+				for (i = full; i < Size; ++i)
+				{
+					out[i] = lhs[i] - rhs[i];
+				}
+			}
+		};
+
+		template <>
+		struct SMatrixSimd<float, 2> : SimdElementwise<4>
+		{
+			static constexpr bool enabled = true;
+
+			static void multiply(const float* lhs, const float* rhs, float* out) noexcept
+			{
+				const __m128 a = _mm_loadu_ps(lhs);
+				const __m128 b = _mm_loadu_ps(rhs);
+
+				// (a0 a0 a2 a2) * (b0 b1 b0 b1) + (a1 a1 a3 a3) * (b2 b3 b2 b3)
+				const __m128 first = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0)), _mm_movelh_ps(b, b));
+				const __m128 second = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1)), _mm_movehl_ps(b, b));
+				_mm_storeu_ps(out, _mm_add_ps(first, second));
+			}
+
+			static void transpose(const float* in, float* out) noexcept
+			{
+				const __m128 a = _mm_loadu_ps(in);
+				_mm_storeu_ps(out, _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 2, 0)));
+			}
+		};
+
+		template <>
+		struct SMatrixSimd<float, 3> : SimdElementwise<9>
+		{
+			static constexpr bool enabled = true;
+
+			// Rows are three floats wide: the first two rows are read and written four wide, the spare lane of a
+			// store lands on the next row before that row is written; the last row goes through 2 + 1 float moves
+			static void multiply(const float* lhs, const float* rhs, float* out) noexcept
+			{
+				const __m128 b0 = _mm_loadu_ps(rhs);
+				const __m128 b1 = _mm_loadu_ps(rhs + 3);
+				const __m128 b2 = _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(rhs + 6)), _mm_load_ss(rhs + 8));
+
+				__m128 rows[3];
+				for (size_t i = 0; i < 3; ++i)
+				{
+					const float* const a = lhs + i * 3;
+					rows[i] = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), b0), _mm_mul_ps(_mm_set1_ps(a[1]), b1)),
+						_mm_mul_ps(_mm_set1_ps(a[2]), b2));
+				}
+
+				_mm_storeu_ps(out, rows[0]);
+				_mm_storeu_ps(out + 3, rows[1]);
+				_mm_storel_pi(reinterpret_cast<__m64*>(out + 6), rows[2]);
+				_mm_store_ss(out + 8, _mm_movehl_ps(rows[2], rows[2]));
+			}
+
+			// (a0 a1 a2 a3 | a4 a5 a6 a7 | a8) -> (a0 a3 a6 a1 | a4 a7 a2 a5 | a8)
+			static void transpose(const float* in, float* out) noexcept
+			{
+				const __m128 v0 = _mm_loadu_ps(in);
+				const __m128 v1 = _mm_loadu_ps(in + 4);
+
+				const __m128 a6_a1 = _mm_shuffle_ps(v1, v0, _MM_SHUFFLE(1, 1, 2, 2));
+				const __m128 a2_a5 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2));
+				_mm_storeu_ps(out, _mm_shuffle_ps(v0, a6_a1, _MM_SHUFFLE(2, 0, 3, 0)));
+				_mm_storeu_ps(out + 4, _mm_shuffle_ps(v1, a2_a5, _MM_SHUFFLE(2, 0, 3, 0)));
+				out[8] = in[8];
+			}
+		};
+
+		template <>
+		struct SMatrixSimd<float, 4> : SimdElementwise<16>
+		{
+			static constexpr bool enabled = true;
+
+			static void multiply(const float* lhs, const float* rhs, float* out) noexcept
+			{
+				const __m128 b0 = _mm_loadu_ps(rhs);
+				const __m128 b1 = _mm_loadu_ps(rhs + 4);
+				const __m128 b2 = _mm_loadu_ps(rhs + 8);
+				const __m128 b3 = _mm_loadu_ps(rhs + 12);
+
+				for (size_t i = 0; i < 4; ++i)
+				{
+					const float* const a = lhs + i * 4;
+					const __m128 row = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), b0), _mm_mul_ps(_mm_set1_ps(a[1]), b1)),
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), b2), _mm_mul_ps(_mm_set1_ps(a[3]), b3)));
+					_mm_storeu_ps(out + i * 4, row);
+				}
+			}
+
+			static void transpose(const float* in, float* out) noexcept
+			{
+				__m128 r0 = _mm_loadu_ps(in);
+				__m128 r1 = _mm_loadu_ps(in + 4);
+				__m128 r2 = _mm_loadu_ps(in + 8);
+				__m128 r3 = _mm_loadu_ps(in + 12);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(out, r0);
+				_mm_storeu_ps(out + 4, r1);
+				_mm_storeu_ps(out + 8, r2);
+				_mm_storeu_ps(out + 12, r3);
+			}
+		};
+
+		template <>
+		struct SMatrixSimd<double, 2> : SimdElementwise<4>
+		{
+			static constexpr bool enabled = true;
+
+			static void multiply(const double* lhs, const double* rhs, double* out) noexcept
+			{
+				const __m128d b0 = _mm_loadu_pd(rhs);
+				const __m128d b1 = _mm_loadu_pd(rhs + 2);
+
+				for (size_t i = 0; i < 2; ++i)
+				{
+					const double* const a = lhs + i * 2;
+					_mm_storeu_pd(out + i * 2, _mm_add_pd(_mm_mul_pd(_mm_set1_pd(a[0]), b0), _mm_mul_pd(_mm_set1_pd(a[1]), b1)));
+				}
+			}
+
+			static void transpose(const double* in, double* out) noexcept
+			{
+				const __m128d r0 = _mm_loadu_pd(in);
+				const __m128d r1 = _mm_loadu_pd(in + 2);
+				_mm_storeu_pd(out, _mm_unpacklo_pd(r0, r1));
+				_mm_storeu_pd(out + 2, _mm_unpackhi_pd(r0, r1));
+			}
+		};
+
+		template <>
+		struct SMatrixSimd<double, 3> : SimdElementwise<9>
+		{
+			static constexpr bool enabled = true;
+
+			// The first two columns of every row in a register, the third one on the scalar unit
+			static void multiply(const double* lhs, const double* rhs, double* out) noexcept
+			{
+				const __m128d b0 = _mm_loadu_pd(rhs);
+				const __m128d b1 = _mm_loadu_pd(rhs + 3);
+				const __m128d b2 = _mm_loadu_pd(rhs + 6);
+
+				for (size_t i = 0; i < 3; ++i)
+				{
+					const double* const a = lhs + i * 3;
+					const __m128d row = _mm_add_pd(
+						_mm_add_pd(_mm_mul_pd(_mm_set1_pd(a[0]), b0), _mm_mul_pd(_mm_set1_pd(a[1]), b1)),
+						_mm_mul_pd(_mm_set1_pd(a[2]), b2));
+					_mm_storeu_pd(out + i * 3, row);
+					out[i * 3 + 2] = a[0] * rhs[2] + a[1] * rhs[5] + a[2] * rhs[8];
+				}
+			}
+
+			// (a0 a1 | a2 a3 | a4 a5 | a6 a7 | a8) -> (a0 a3 | a6 a1 | a4 a7 | a2 a5 | a8)
+			static void transpose(const double* in, double* out) noexcept
+			{
+				const __m128d p0 = _mm_loadu_pd(in);
+				const __m128d p1 = _mm_loadu_pd(in + 2);
+				const __m128d p2 = _mm_loadu_pd(in + 4);
+				const __m128d p3 = _mm_loadu_pd(in + 6);
+				_mm_storeu_pd(out, _mm_shuffle_pd(p0, p1, 2));
+				_mm_storeu_pd(out + 2, _mm_shuffle_pd(p3, p0, 2));
+				_mm_storeu_pd(out + 4, _mm_shuffle_pd(p2, p3, 2));
+				_mm_storeu_pd(out + 6, _mm_shuffle_pd(p1, p2, 2));
+				out[8] = in[8];
+			}
+		};
+
+		template <>
+		struct SMatrixSimd<double, 4> : SimdElementwise<16>
+		{
+			static constexpr bool enabled = true;
+
+			// Every row is two register halves
+			static void multiply(const double* lhs, const double* rhs, double* out) noexcept
+			{
+				for (size_t half = 0; half < 4; half += 2)
+				{
+					const __m128d b0 = _mm_loadu_pd(rhs + half);
+					const __m128d b1 = _mm_loadu_pd(rhs + 4 + half);
+					const __m128d b2 = _mm_loadu_pd(rhs + 8 + half);
+					const __m128d b3 = _mm_loadu_pd(rhs + 12 + half);
+
+					for (size_t i = 0; i < 4; ++i)
+					{
+						const double* const a = lhs + i * 4;
+						const __m128d row = _mm_add_pd(
+							_mm_add_pd(_mm_mul_pd(_mm_set1_pd(a[0]), b0), _mm_mul_pd(_mm_set1_pd(a[1]), b1)),
+							_mm_add_pd(_mm_mul_pd(_mm_set1_pd(a[2]), b2), _mm_mul_pd(_mm_set1_pd(a[3]), b3)));
+						_mm_storeu_pd(out + i * 4 + half, row);
+					}
+				}
+			}
+
+			// Four 2 x 2 blocks, the off-diagonal ones trade places
+			static void transpose(const double* in, double* out) noexcept
+			{
+				for (size_t block_row = 0; block_row < 4; block_row += 2)
+				{
+					for (size_t block_column = 0; block_column < 4; block_column += 2)
+					{
+						const __m128d r0 = _mm_loadu_pd(in + block_row * 4 + block_column);
+						const __m128d r1 = _mm_loadu_pd(in + (block_row + 1) * 4 + block_column);
+						_mm_storeu_pd(out + block_column * 4 + block_row, _mm_unpacklo_pd(r0, r1));
+						_mm_storeu_pd(out + (block_column + 1) * 4 + block_row, _mm_unpackhi_pd(r0, r1));
+					}
+				}
+			}
+		};
+#endif
+	}
+}
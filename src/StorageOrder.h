@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Allocator.h"
+
+namespace PrimMatrix
+{
+	// Storage orders map (row, column) to an offset in a buffer made of lines - rows for row-major, columns
+	// for column-major - each holding line_size contiguous elements, with lines leading_dimension elements apart
+
+	struct ColumnMajor;
+
+	struct RowMajor
+	{
+		using transposed = ColumnMajor;
+		static constexpr bool row_major = true;
+
+		static constexpr size_t lines(const size_t rows, size_t) noexcept { return rows; }
+		static constexpr size_t line_size(size_t, const size_t columns) noexcept { return columns; }
+
+		static constexpr size_t offset(const size_t row, const size_t column, const size_t leading_dimension) noexcept
+		{
+			return row * leading_dimension + column;
+		}
+
+		static constexpr size_t row_stride(const size_t leading_dimension) noexcept { return leading_dimension; }
+		static constexpr size_t column_stride(size_t) noexcept { return 1; }
+	};
+
+	struct ColumnMajor
+	{
+		using transposed = RowMajor;
+		static constexpr bool row_major = false;
+
+		static constexpr size_t lines(size_t, const size_t columns) noexcept { return columns; }
+		static constexpr size_t line_size(const size_t rows, size_t) noexcept { return rows; }
+
+		static constexpr size_t offset(const size_t row, const size_t column, const size_t leading_dimension) noexcept
+		{
+			return column * leading_dimension + row;
+		}
+
+		static constexpr size_t row_stride(size_t) noexcept { return 1; }
+		static constexpr size_t column_stride(const size_t leading_dimension) noexcept { return leading_dimension; }
+	};
+
+	// Requests a leading dimension wider than a line, so lines do not all map onto the same cache sets
+	struct Padding
+	{
+		static constexpr size_t automatic = 0;
+
+		// In elements, never narrower than a line; automatic lets padded_leading_dimension choose
+		size_t leading_dimension = automatic;
+	};
+
+	// Rounds lines up to whole cache lines and adds one more when the stride would be a multiple of 512 bytes,
+	// which is where consecutive lines start hitting the same L1/L2 sets (power-of-two widths like 1024 or 4096)
+	template <class T>
+	size_t padded_leading_dimension(const size_t line_size)
+	{
+		if (line_size == 0)
+		{
+			return 0;
+		}
+
+		const size_t cache_line_elements = std::max<size_t>(cache_line_size / sizeof(T), 1);
+
+		size_t leading_dimension = (line_size + cache_line_elements - 1) / cache_line_elements * cache_line_elements;
+		if (leading_dimension * sizeof(T) % 512 == 0)
+		{
+			leading_dimension += cache_line_elements;
+		}
+
+		return leading_dimension;
+	}
+
+	namespace detail
+	{
+		template <class T>
+		size_t resolve_padding(const Padding& padding, const size_t line_size)
+		{
+			if (padding.leading_dimension == Padding::automatic)
+			{
+				return padded_leading_dimension<T>(line_size);
+			}
+
+			return std::max(padding.leading_dimension, line_size);
+		}
+
+		// Row and column of the element stored at index of a dense rows x columns buffer
+		template <class Order>
+		constexpr size_t row_at(const size_t index, const size_t rows, const size_t columns) noexcept
+		{
+			return Order::row_major ? index / columns : index % rows;
+		}
+
+		template <class Order>
+		constexpr size_t column_at(const size_t index, const size_t rows, const size_t columns) noexcept
+		{
+			return Order::row_major ? index % columns : index / rows;
+		}
+
+		// Visits every (row, column) in storage order, so writes go through memory sequentially
+		template <class Order, class Function>
+		void for_each_index(const size_t rows, const size_t columns, Function&& function)
+		{
+			if (Order::row_major)
+			{
+				for (size_t row = 0; row < rows; ++row)
+				{
+					for (size_t column = 0; column < columns; ++column)
+					{
+						function(row, column);
+					}
+				}
+			}
+			else
+			{
+				for (size_t column = 0; column < columns; ++column)
+				{
+					for (size_t row = 0; row < rows; ++row)
+					{
+						function(row, column);
+					}
+				}
+			}
+		}
+	}
+}
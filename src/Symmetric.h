@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "Epilogue.h"
+#include "Gemm.h"
+#include "Transpose.h"
+
+namespace PrimMatrix
+{
+	// Which triangle of a symmetric matrix is computed or stored; the diagonal belongs to both
+	enum class ETriangle
+	{
+		lower,
+		upper
+	};
+
+	// Whether the triangle a symmetric product computed is also copied over the other one
+	enum class ESymmetricFill
+	{
+		triangle,
+		full
+	};
+
+	namespace detail
+	{
+		// Side of the diagonal blocks. Everything off the diagonal goes through the GEMM engine exactly once,
+		// only the diagonal blocks are computed in full, so the waste is block / size of the product
+		constexpr size_t symmetric_block_size = 128;
+
+		inline ETriangle opposite(const ETriangle triangle) noexcept
+		{
+			return triangle == ETriangle::lower ? ETriangle::upper : ETriangle::lower;
+		}
+
+		// The triangle of C = alpha * A * A^T + beta * C, C is n x n and A is n x k; the other triangle is not touched.
+		// With mirror the computed triangle is then copied over the other one
+		template <class T>
+		void syrk(
+			const size_t n, const size_t k,
+			const T& alpha,
+			const T* a, const size_t a_rs, const size_t a_cs,
+			const T& beta,
+			T* c, size_t c_rs, size_t c_cs,
+			ETriangle triangle,
+			const bool mirror)
+		{
+			// The lower triangle of a column-major C is the upper triangle of its row-major transpose, and
+			// transposing C does not change A * A^T; from here on C is walked along rows
+			if (c_cs != 1 && c_rs == 1)
+			{
+				std::swap(c_rs, c_cs);
+				triangle = opposite(triangle);
+			}
+
+			const bool lower = triangle == ETriangle::lower;
+			T* const diagonal = gemm_pack_buffer<T, 3>(symmetric_block_size * symmetric_block_size);
+
+			for (size_t begin = 0; begin < n; begin += symmetric_block_size)
+			{
+				const size_t block = std::min(symmetric_block_size, n - begin);
+				const size_t end = begin + block;
+				const T* const a_block = a + begin * a_rs;
+
+				// Diagonal block in full on a copy, then only its own triangle goes back
+				for (size_t i = 0; i < block; ++i)
+				{
+					for (size_t j = 0; j < block; ++j)
+					{
+						diagonal[i * block + j] = c[(begin + i) * c_rs + (begin + j) * c_cs];
+					}
+				}
+
+				gemm(block, block, k, alpha, a_block, a_rs, a_cs, a_block, a_cs, a_rs, beta, diagonal, block, size_t{ 1 }, NoEpilogue{});
+
+				for (size_t i = 0; i < block; ++i)
+				{
+					for (size_t j = lower ? 0 : i; j < (lower ? i + 1 : block); ++j)
+					{
+						c[(begin + i) * c_rs + (begin + j) * c_cs] = diagonal[i * block + j];
+					}
+				}
+
+				if (end == n)
+				{
+					continue;
+				}
+
+				// The panel below (lower) or right of (upper) the diagonal block
+				if (lower)
+				{
+					gemm(
+						n - end, block, k,
+						alpha,
+						a + end * a_rs, a_rs, a_cs,
+						a_block, a_cs, a_rs,
+						beta,
+						c + end * c_rs + begin * c_cs, c_rs, c_cs,
+						NoEpilogue{});
+				}
+				else
+				{
+					gemm(
+						block, n - end, k,
+						alpha,
+						a_block, a_rs, a_cs,
+						a + end * a_rs, a_cs, a_rs,
+						beta,
+						c + begin * c_rs + end * c_cs, c_rs, c_cs,
+						NoEpilogue{});
+				}
+			}
+
+			if (!mirror)
+			{
+				return;
+			}
+
+			for (size_t begin = 0; begin < n; begin += symmetric_block_size)
+			{
+				const size_t block = std::min(symmetric_block_size, n - begin);
+				const size_t end = begin + block;
+				T* const diagonal_block = c + begin * c_rs + begin * c_cs;
+
+				for (size_t i = 0; i < block; ++i)
+				{
+					for (size_t j = i + 1; j < block; ++j)
+					{
+						T& upper_value = diagonal_block[i * c_rs + j * c_cs];
+						T& lower_value = diagonal_block[j * c_rs + i * c_cs];
+						if (lower)
+						{
+							upper_value = lower_value;
+						}
+						else
+						{
+							lower_value = upper_value;
+						}
+					}
+				}
+
+				if (end == n)
+				{
+					continue;
+				}
+
+				T* const below = c + end * c_rs + begin * c_cs;
+				T* const right = c + begin * c_rs + end * c_cs;
+				if (lower)
+				{
+					transpose(n - end, block, below, c_rs, right, c_rs);
+				}
+				else
+				{
+					transpose(block, n - end, right, c_rs, below, c_rs);
+				}
+			}
+		}
+
+		// C = alpha * S * B + beta * C for a symmetric n x n S of which only the given triangle of s is read, B is n x m.
+		// Each block row of S is a stored panel, the diagonal block and a panel read through the transposed strides
+		template <class T>
+		void symm(
+			const size_t n, const size_t m,
+			const T& alpha,
+			const T* s, size_t s_rs, size_t s_cs,
+			const ETriangle triangle,
+			const T* b, const size_t b_rs, const size_t b_cs,
+			const T& beta,
+			T* c, const size_t c_rs, const size_t c_cs)
+		{
+			// The upper triangle of S is the lower triangle of S^T, which is S again
+			if (triangle == ETriangle::upper)
+			{
+				std::swap(s_rs, s_cs);
+			}
+
+			T* const diagonal = gemm_pack_buffer<T, 3>(symmetric_block_size * symmetric_block_size);
+
+			for (size_t begin = 0; begin < n; begin += symmetric_block_size)
+			{
+				const size_t block = std::min(symmetric_block_size, n - begin);
+				const size_t end = begin + block;
+				const T* const s_block = s + begin * s_rs + begin * s_cs;
+				T* const c_block = c + begin * c_rs;
+
+				for (size_t i = 0; i < block; ++i)
+				{
+					for (size_t j = 0; j <= i; ++j)
+					{
+						diagonal[i * block + j] = diagonal[j * block + i] = s_block[i * s_rs + j * s_cs];
+					}
+				}
+
+				gemm(block, m, block, alpha, diagonal, block, size_t{ 1 }, b + begin * b_rs, b_rs, b_cs, beta, c_block, c_rs, c_cs, NoEpilogue{});
+
+				if (begin > 0)
+				{
+					gemm(block, m, begin, alpha, s + begin * s_rs, s_rs, s_cs, b, b_rs, b_cs, T{ 1 }, c_block, c_rs, c_cs, NoEpilogue{});
+				}
+
+				if (end < n)
+				{
+					gemm(
+						block, m, n - end,
+						alpha,
+						s + end * s_rs + begin * s_cs, s_cs, s_rs,
+						b + end * b_rs, b_rs, b_cs,
+						T{ 1 },
+						c_block, c_rs, c_cs,
+						NoEpilogue{});
+				}
+			}
+		}
+	}
+}
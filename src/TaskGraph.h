@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Matrix_Exception.h"
+#include "ThreadPool.h"
+
+namespace PrimMatrix
+{
+	// One executed task as recorded by a traced TaskGraph::run
+	struct TaskTrace
+	{
+		using clock = std::chrono::steady_clock;
+
+		size_t task;
+		const char* name;
+		size_t worker;
+		// The task was taken from another worker's queue
+		bool stolen;
+		clock::time_point begin;
+		clock::time_point end;
+	};
+
+	// Tasks with data dependencies, executed over a ThreadPool. Every worker keeps its own queue of ready tasks and
+	// takes the newest one first, so a tile finished by a worker is usually continued by it while the data is in cache.
+	// A worker without ready tasks steals the oldest one of another worker, so nobody idles while tiles are left.
+	// A worker that finds nothing to steal spins briefly, then sleeps until a task becomes ready.
+	// A graph is built once and can be run any number of times
+	class TaskGraph
+	{
+	public:
+		using size_type = size_t;
+		using task_id = size_type;
+
+		TaskGraph() = default;
+
+		explicit TaskGraph(const size_type expected_tasks)
+		{
+			tasks_.reserve(expected_tasks);
+		}
+
+		size_type size() const noexcept { return tasks_.size(); }
+		bool empty() const noexcept { return tasks_.empty(); }
+
+		// name is only used by the traces and must outlive them
+		template <class Function>
+		task_id add(Function&& function, const char* name = nullptr)
+		{
+			tasks_.push_back(Task{ std::function<void()>{ std::forward<Function>(function) }, name, {}, 0 });
+			return tasks_.size() - 1;
+		}
+
+		// task starts only after prerequisite has finished. Tasks are added in an order their dependencies respect,
+		// so a prerequisite has to be added before the task, which also keeps the graph free of cycles
+		void depend(const task_id task, const task_id prerequisite)
+		{
+			if (task >= tasks_.size() || prerequisite >= task)
+			{
+				throw Matrix_InvalidDependency{ task, prerequisite };
+			}
+
+			tasks_[prerequisite].successors.push_back(task);
+			++tasks_[task].prerequisites;
+		}
+
+		// Blocks until every task is done. The first exception thrown by a task is rethrown here, the tasks not
+		// started by then are skipped
+		void run(ThreadPool& pool = ThreadPool::instance())
+		{
+			execute(pool, nullptr);
+		}
+
+		// Same as run, and returns what every task ran on and when, in the order the tasks finished
+		std::vector<TaskTrace> run_traced(ThreadPool& pool = ThreadPool::instance())
+		{
+			std::vector<TaskTrace> trace;
+			execute(pool, &trace);
+
+			std::sort(trace.begin(), trace.end(), [](const TaskTrace& lhs, const TaskTrace& rhs) { return lhs.end < rhs.end; });
+			return trace;
+		}
+
+	private:
+		struct Task
+		{
+			std::function<void()> function;
+			const char* name;
+			std::vector<task_id> successors;
+			size_type prerequisites;
+		};
+
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<task_id> ready;
+			std::vector<TaskTrace> trace;
+		};
+
+		struct Execution
+		{
+			std::unique_ptr<std::atomic<size_type>[]> pending;
+			std::unique_ptr<WorkerQueue[]> queues;
+			size_type worker_count;
+			std::atomic<size_type> remaining;
+			// Tasks sitting in the queues, and workers sleeping until there are some
+			std::atomic<size_type> available{ 0 };
+			std::atomic<size_type> sleepers{ 0 };
+			std::mutex idle_mutex;
+			std::condition_variable idle;
+			std::atomic<bool> failed{ false };
+			std::mutex error_mutex;
+			std::exception_ptr error;
+		};
+
+		// Empty polls a worker spins through before it goes to sleep
+		static constexpr size_type idle_spins = 64;
+
+		void execute(ThreadPool& pool, std::vector<TaskTrace>* trace)
+		{
+			if (tasks_.empty())
+			{
+				return;
+			}
+
+			Execution execution;
+			execution.pending.reset(new std::atomic<size_type>[tasks_.size()]);
+			execution.worker_count = std::max<size_type>(std::min(pool.concurrency(), tasks_.size()), 1);
+			execution.queues.reset(new WorkerQueue[execution.worker_count]);
+			execution.remaining = tasks_.size();
+
+			// Tasks ready from the start are dealt round-robin, the stealing evens out the rest
+			size_type next_queue = 0;
+			for (task_id task = 0; task < tasks_.size(); ++task)
+			{
+				execution.pending[task] = tasks_[task].prerequisites;
+				if (tasks_[task].prerequisites == 0)
+				{
+					execution.queues[next_queue].ready.push_back(task);
+					next_queue = (next_queue + 1) % execution.worker_count;
+					++execution.available;
+				}
+			}
+
+			// Each pool task is one worker loop. Whichever thread picks a loop up serves its queue, so the graph also
+			// completes when the pool runs the loops one after another
+			pool.run(execution.worker_count, [&](const size_type worker)
+			{
+				work(execution, worker, trace != nullptr);
+			});
+
+			if (execution.error)
+			{
+				std::rethrow_exception(execution.error);
+			}
+
+			if (trace)
+			{
+				for (size_type worker = 0; worker < execution.worker_count; ++worker)
+				{
+					trace->insert(trace->end(), execution.queues[worker].trace.begin(), execution.queues[worker].trace.end());
+				}
+			}
+		}
+
+		void work(Execution& execution, const size_type worker, const bool traced)
+		{
+			size_type empty_polls = 0;
+			while (execution.remaining != 0 && !execution.failed)
+			{
+				task_id task = 0;
+				bool stolen = false;
+				if (!pop(execution, worker, task))
+				{
+					if (!steal(execution, worker, task))
+					{
+						// Everything left is waiting on tasks other workers are running
+						if (++empty_polls < idle_spins)
+						{
+							std::this_thread::yield();
+						}
+						else
+						{
+							sleep(execution);
+							empty_polls = 0;
+						}
+
+						continue;
+					}
+
+					stolen = true;
+				}
+
+				empty_polls = 0;
+				const TaskTrace::clock::time_point begin = traced ? TaskTrace::clock::now() : TaskTrace::clock::time_point{};
+
+				try
+				{
+					tasks_[task].function();
+				}
+				catch (...)
+				{
+					{
+						std::lock_guard<std::mutex> lock{ execution.error_mutex };
+						if (!execution.error)
+						{
+							execution.error = std::current_exception();
+						}
+					}
+
+					execution.failed = true;
+					wake(execution);
+					return;
+				}
+
+				if (traced)
+				{
+					execution.queues[worker].trace.push_back(TaskTrace{ task, tasks_[task].name, worker, stolen, begin, TaskTrace::clock::now() });
+				}
+
+				bool released = false;
+				for (const task_id successor : tasks_[task].successors)
+				{
+					if (execution.pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						// Counted before it can be taken, so the count never drops below zero
+						++execution.available;
+						{
+							std::lock_guard<std::mutex> lock{ execution.queues[worker].mutex };
+							execution.queues[worker].ready.push_back(successor);
+						}
+
+						released = true;
+					}
+				}
+
+				if (--execution.remaining == 0 || released)
+				{
+					wake(execution);
+				}
+			}
+		}
+
+		// Sleeps until a task is ready or the run is over. Wakers check sleepers after publishing their change and
+		// take the mutex before notifying, so a worker going to sleep either sees the change or gets the notification
+		static void sleep(Execution& execution)
+		{
+			std::unique_lock<std::mutex> lock{ execution.idle_mutex };
+			++execution.sleepers;
+			execution.idle.wait(lock, [&] { return execution.available != 0 || execution.remaining == 0 || execution.failed; });
+			--execution.sleepers;
+		}
+
+		static void wake(Execution& execution)
+		{
+			if (execution.sleepers != 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock{ execution.idle_mutex };
+				}
+
+				execution.idle.notify_all();
+			}
+		}
+
+		static bool pop(Execution& execution, const size_type worker, task_id& task)
+		{
+			WorkerQueue& queue = execution.queues[worker];
+			std::lock_guard<std::mutex> lock{ queue.mutex };
+			if (queue.ready.empty())
+			{
+				return false;
+			}
+
+			task = queue.ready.back();
+			queue.ready.pop_back();
+			--execution.available;
+			return true;
+		}
+
+		static bool steal(Execution& execution, const size_type thief, task_id& task)
+		{
+			for (size_type offset = 1; offset < execution.worker_count; ++offset)
+			{
+				WorkerQueue& victim = execution.queues[(thief + offset) % execution.worker_count];
+
+				std::lock_guard<std::mutex> lock{ victim.mutex };
+				if (!victim.ready.empty())
+				{
+					task = victim.ready.front();
+					victim.ready.pop_front();
+					--execution.available;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		std::vector<Task> tasks_;
+	};
+}
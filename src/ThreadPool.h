@@ -0,0 +1,332 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Numa.h"
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace PrimMatrix
+{
+	// Fixed set of workers shared by the parallel operations, the calling thread takes part in every run.
+	// Unless the NUMA policy is local, on machines with several nodes the workers are kept on the nodes in contiguous
+	// groups and parallel_for hands chunk i to thread i, the caller being thread 0, so memory first touched through
+	// parallel_for is later worked on from the node it was placed on
+	class ThreadPool
+	{
+	public:
+		using size_type = size_t;
+
+		explicit ThreadPool(const size_type worker_count, const bool pin_workers = false)
+		{
+			start(worker_count, pin_workers);
+		}
+
+		~ThreadPool()
+		{
+			stop();
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Library-wide pool, one worker per hardware thread besides the caller
+		static ThreadPool& instance()
+		{
+			static ThreadPool pool{ default_worker_count() };
+			return pool;
+		}
+
+		static size_type default_worker_count() noexcept
+		{
+			const size_type hardware_threads = std::thread::hardware_concurrency();
+			return hardware_threads > 1 ? hardware_threads - 1 : 0;
+		}
+
+		size_type worker_count() const noexcept { return workers_.size(); }
+		size_type concurrency() const noexcept { return workers_.size() + 1; }
+		bool pinned() const noexcept { return pinned_; }
+		bool node_bound() const noexcept { return node_bound_; }
+
+		// Must not be called while a run is in progress
+		void resize(const size_type worker_count, const bool pin_workers = false)
+		{
+			std::lock_guard<std::mutex> run_lock{ run_mutex_ };
+
+			stop();
+			start(worker_count, pin_workers);
+		}
+
+		// Calls function(task_index) for every index in [0, task_count), blocks until all of them are done.
+		// The first exception thrown by a task is rethrown here.
+		template <class Function>
+		void run(const size_type task_count, Function&& function)
+		{
+			run_tasks(task_count, std::forward<Function>(function), false);
+		}
+
+		// Splits [begin, end) into chunks of at least grain elements and calls function(chunk_begin, chunk_end)
+		template <class Function>
+		void parallel_for(const size_type begin, const size_type end, const size_type grain, Function&& function)
+		{
+			if (begin >= end)
+			{
+				return;
+			}
+
+			const size_type length = end - begin;
+			const size_type max_chunks = std::max<size_type>(length / std::max<size_type>(grain, 1), 1);
+			const size_type chunk_count = std::min(max_chunks, concurrency());
+			const size_type chunk_size = (length + chunk_count - 1) / chunk_count;
+
+			run_tasks(chunk_count, [&](const size_type chunk)
+			{
+				const size_type chunk_begin = begin + chunk * chunk_size;
+				const size_type chunk_end = std::min(end, chunk_begin + chunk_size);
+				if (chunk_begin < chunk_end)
+				{
+					function(chunk_begin, chunk_end);
+				}
+			}, node_bound_);
+		}
+
+	private:
+		// With fixed_threads, task i runs on thread i, task_count must not exceed concurrency()
+		template <class Function>
+		void run_tasks(const size_type task_count, Function&& function, const bool fixed_threads)
+		{
+			if (task_count == 0)
+			{
+				return;
+			}
+
+			// Nested runs from inside a task execute inline, the workers are already busy with the outer one
+			if (workers_.empty() || task_count == 1 || inside_task())
+			{
+				for (size_type task_index = 0; task_index < task_count; ++task_index)
+				{
+					function(task_index);
+				}
+
+				return;
+			}
+
+			using function_type = typename std::remove_reference<Function>::type;
+
+			std::lock_guard<std::mutex> run_lock{ run_mutex_ };
+			{
+				std::lock_guard<std::mutex> lock{ mutex_ };
+
+				invoke_ = [](void* context, const size_type task_index)
+				{
+					(*static_cast<function_type*>(context))(task_index);
+				};
+				context_ = const_cast<void*>(static_cast<const void*>(std::addressof(function)));
+				task_count_ = task_count;
+				fixed_threads_ = fixed_threads;
+				next_task_ = 0;
+				busy_workers_ = workers_.size();
+				error_ = nullptr;
+				++generation_;
+			}
+
+			work_available_.notify_all();
+			execute_tasks(0);
+
+			std::unique_lock<std::mutex> lock{ mutex_ };
+			work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+
+			if (error_)
+			{
+				std::rethrow_exception(error_);
+			}
+		}
+
+		static bool& inside_task() noexcept
+		{
+			thread_local bool inside = false;
+			return inside;
+		}
+
+		void start(const size_type worker_count, const bool pin_workers)
+		{
+			// New workers only wait for runs started after them, the generation keeps counting across resizes
+			size_type generation = 0;
+			{
+				std::lock_guard<std::mutex> lock{ mutex_ };
+				stopping_ = false;
+				generation = generation_;
+			}
+
+			pinned_ = pin_workers;
+			node_bound_ = NumaTopology::system().node_count() > 1 && numa_policy() != ENumaPolicy::local;
+
+			workers_.reserve(worker_count);
+			for (size_type worker_index = 0; worker_index < worker_count; ++worker_index)
+			{
+				workers_.emplace_back([this, worker_index, generation] { worker_loop(worker_index, generation); });
+
+				if (pin_workers || node_bound_)
+				{
+					place(workers_.back(), worker_index + 1, worker_count + 1, pin_workers, node_bound_);
+				}
+			}
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ mutex_ };
+				stopping_ = true;
+			}
+
+			work_available_.notify_all();
+			for (auto& worker : workers_)
+			{
+				worker.join();
+			}
+
+			workers_.clear();
+		}
+
+		// A pinned thread gets one CPU, a thread bound to a node all of the node's CPUs
+		static void place(std::thread& thread, const size_type thread_index, const size_type thread_count, const bool pin, const bool node_bound)
+		{
+#if defined(__linux__)
+			const NumaTopology& topology = NumaTopology::system();
+
+			cpu_set_t cpu_set;
+			CPU_ZERO(&cpu_set);
+			if (node_bound)
+			{
+				const size_type node = topology.node_of_thread(thread_index, thread_count);
+				const std::vector<size_t>& cpus = topology.cpus(node);
+				if (pin)
+				{
+					// Threads of a node are spread over its CPUs starting from the node's first thread
+					const size_type first_thread = (node * thread_count + topology.node_count() - 1) / topology.node_count();
+					CPU_SET(cpus[(thread_index - first_thread) % cpus.size()], &cpu_set);
+				}
+				else
+				{
+					for (const size_t cpu : cpus)
+					{
+						CPU_SET(cpu, &cpu_set);
+					}
+				}
+			}
+			else
+			{
+				const size_type cpu_count = std::max<size_type>(std::thread::hardware_concurrency(), 1);
+				CPU_SET(thread_index % cpu_count, &cpu_set);
+			}
+
+			pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+#else
+			(void)thread;
+			(void)thread_index;
+			(void)thread_count;
+			(void)pin;
+			(void)node_bound;
+#endif
+		}
+
+		void worker_loop(const size_type worker_index, size_type seen_generation)
+		{
+			inside_task() = true;
+
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock{ mutex_ };
+					work_available_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+
+					if (stopping_)
+					{
+						return;
+					}
+
+					seen_generation = generation_;
+				}
+
+				execute_tasks(worker_index + 1);
+
+				std::lock_guard<std::mutex> lock{ mutex_ };
+				if (--busy_workers_ == 0)
+				{
+					work_done_.notify_one();
+				}
+			}
+		}
+
+		void execute_tasks(const size_type thread_index)
+		{
+			const bool was_inside = inside_task();
+			inside_task() = true;
+
+			if (fixed_threads_)
+			{
+				if (thread_index < task_count_)
+				{
+					execute_task(thread_index);
+				}
+			}
+			else
+			{
+				for (size_type task_index = next_task_.fetch_add(1); task_index < task_count_; task_index = next_task_.fetch_add(1))
+				{
+					execute_task(task_index);
+				}
+			}
+
+			inside_task() = was_inside;
+		}
+
+		void execute_task(const size_type task_index)
+		{
+			try
+			{
+				invoke_(context_, task_index);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock{ mutex_ };
+				if (!error_)
+				{
+					error_ = std::current_exception();
+				}
+			}
+		}
+
+		std::vector<std::thread> workers_;
+		bool pinned_ = false;
+		bool node_bound_ = false;
+
+		std::mutex run_mutex_;
+		std::mutex mutex_;
+		std::condition_variable work_available_;
+		std::condition_variable work_done_;
+
+		void (*invoke_)(void*, size_type) = nullptr;
+		void* context_ = nullptr;
+		size_type task_count_ = 0;
+		bool fixed_threads_ = false;
+		std::atomic<size_type> next_task_{ 0 };
+		size_type busy_workers_ = 0;
+		size_type generation_ = 0;
+		bool stopping_ = false;
+		std::exception_ptr error_;
+	};
+}
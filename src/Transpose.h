@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Kernels.h"
+#include "ThreadPool.h"
+
+namespace PrimMatrix
+{
+	namespace detail
+	{
+		// Tile side in bytes, a source tile and its destination fit in L1 together (64x64 floats, 32x32 doubles)
+		constexpr size_t transpose_tile_bytes = 256;
+
+		// Below this many elements waking the pool costs more than it saves
+		constexpr size_t transpose_parallel_threshold = 512 * 512;
+
+		// Register tiles where they fit, plain copies along the ragged edges
+		template <class T>
+		void transpose_tile(
+			const TransposeKernel<T>& kernel,
+			const size_t rows, const size_t columns,
+			const T* src, const size_t src_ld,
+			T* dst, const size_t dst_ld)
+		{
+			const size_t block = kernel.block;
+
+			size_t row = 0;
+			for (; row + block <= rows; row += block)
+			{
+				size_t column = 0;
+				for (; column + block <= columns; column += block)
+				{
+					kernel.kernel(src + row * src_ld + column, src_ld, dst + column * dst_ld + row, dst_ld);
+				}
+
+				for (; column < columns; ++column)
+				{
+					for (size_t i = row; i < row + block; ++i)
+					{
+						dst[column * dst_ld + i] = src[i * src_ld + column];
+					}
+				}
+			}
+
+			for (; row < rows; ++row)
+			{
+				for (size_t column = 0; column < columns; ++column)
+				{
+					dst[column * dst_ld + row] = src[row * src_ld + column];
+				}
+			}
+		}
+
+		template <class T>
+		size_t transpose_tile_size(const TransposeKernel<T>& kernel)
+		{
+			return std::max(transpose_tile_bytes / sizeof(T) / kernel.block, size_t{ 1 }) * kernel.block;
+		}
+
+		// dst[j * dst_ld + i] = src[i * src_ld + j] for a rows x columns source, one cache sized tile at a time
+		template <class T>
+		void transpose_blocked(
+			const size_t rows, const size_t columns,
+			const T* src, const size_t src_ld,
+			T* dst, const size_t dst_ld)
+		{
+			const TransposeKernel<T>& kernel = selected_transpose_kernel<T>();
+			const size_t tile = transpose_tile_size(kernel);
+
+			for (size_t row = 0; row < rows; row += tile)
+			{
+				for (size_t column = 0; column < columns; column += tile)
+				{
+					transpose_tile(
+						kernel,
+						std::min(tile, rows - row), std::min(tile, columns - column),
+						src + row * src_ld + column, src_ld,
+						dst + column * dst_ld + row, dst_ld);
+				}
+			}
+		}
+
+		// Layout agnostic: for column-major storage "rows" are the source columns. Large transposes split
+		// the source's tile rows over the pool, every task writes its own band of destination columns
+		template <class T>
+		void transpose(
+			const size_t rows, const size_t columns,
+			const T* src, const size_t src_ld,
+			T* dst, const size_t dst_ld)
+		{
+			ThreadPool& pool = ThreadPool::instance();
+			if (pool.concurrency() <= 1 || rows * columns < transpose_parallel_threshold)
+			{
+				transpose_blocked(rows, columns, src, src_ld, dst, dst_ld);
+				return;
+			}
+
+			const size_t tile = transpose_tile_size(selected_transpose_kernel<T>());
+			const size_t row_tiles = (rows + tile - 1) / tile;
+			pool.parallel_for(0, row_tiles, 1, [&](const size_t tile_begin, const size_t tile_end)
+			{
+				const size_t row_begin = tile_begin * tile;
+				const size_t row_end = std::min(rows, tile_end * tile);
+				transpose_blocked(row_end - row_begin, columns, src + row_begin * src_ld, src_ld, dst + row_begin, dst_ld);
+			});
+		}
+
+		// Largest register tile of the transpose kernels
+		constexpr size_t transpose_max_block = 8;
+
+		// Swaps register tiles across the diagonal a cache tile at a time, the diagonal tiles and the ragged edge element by element
+		template <class T>
+		void transpose_square_in_place(const size_t size, T* data, const size_t ld)
+		{
+			const TransposeKernel<T>& kernel = selected_transpose_kernel<T>();
+			const size_t block = kernel.block;
+			const size_t full = size / block * block;
+			const size_t tile = transpose_tile_size(kernel);
+
+			T buffer[transpose_max_block * transpose_max_block];
+			for (size_t row_tile = 0; row_tile < full; row_tile += tile)
+			{
+				for (size_t column_tile = row_tile; column_tile < full; column_tile += tile)
+				{
+					for (size_t row = row_tile; row < std::min(row_tile + tile, full); row += block)
+					{
+						for (size_t column = std::max(column_tile, row + block); column < std::min(column_tile + tile, full); column += block)
+						{
+							T* const upper = data + row * ld + column;
+							T* const lower = data + column * ld + row;
+
+							kernel.kernel(upper, ld, buffer, block);
+							kernel.kernel(lower, ld, upper, ld);
+							for (size_t i = 0; i < block; ++i)
+							{
+								std::copy(buffer + i * block, buffer + (i + 1) * block, lower + i * ld);
+							}
+						}
+					}
+				}
+			}
+
+			using std::swap;
+			for (size_t diagonal = 0; diagonal < full; diagonal += block)
+			{
+				for (size_t row = diagonal; row < diagonal + block; ++row)
+				{
+					for (size_t column = row + 1; column < diagonal + block; ++column)
+					{
+						swap(data[row * ld + column], data[column * ld + row]);
+					}
+				}
+			}
+
+			for (size_t row = 0; row < size; ++row)
+			{
+				for (size_t column = std::max(full, row + 1); column < size; ++column)
+				{
+					swap(data[row * ld + column], data[column * ld + row]);
+				}
+			}
+		}
+
+		// Transposes a dense lines x line_size block into line_size x lines in place. The element at p belongs
+		// at p * lines mod (n - 1); every permutation cycle is walked once, a bitmap of one bit per element
+		// marks the elements already placed
+		template <class T>
+		void transpose_cycles(const size_t lines, const size_t line_size, T* data)
+		{
+			if (lines <= 1 || line_size <= 1)
+			{
+				return;
+			}
+
+			const size_t modulus = lines * line_size - 1;
+			std::vector<bool> placed(modulus);
+
+			using std::swap;
+			for (size_t start = 1; start < modulus; ++start)
+			{
+				if (placed[start])
+				{
+					continue;
+				}
+
+				T carried = std::move(data[start]);
+				size_t position = start;
+				do
+				{
+					position = position * lines % modulus;
+					swap(data[position], carried);
+					placed[position] = true;
+				}
+				while (position != start);
+			}
+		}
+	}
+}
@@ -1,7 +1,18 @@
 #include "src/DMatrix.h"
+#include "src/SMatrixInterop.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 // todo, use mocks, lots of repetitive initialization code
@@ -318,6 +329,95 @@ TEST(DMatrix_ConstructionTest, T_009_MoveAssigmentOperator)
 	}
 }
 
+// Fills fresh storage with a pattern, so tests can see which constructors write to it
+template <class T>
+struct pattern_allocator
+{
+	using value_type = T;
+
+	static constexpr unsigned char pattern = 0xAB;
+
+	pattern_allocator() = default;
+
+	template <class U>
+	pattern_allocator(const pattern_allocator<U>&) {}
+
+	T* allocate(const size_t count)
+	{
+		T* memory = std::allocator<T>{}.allocate(count);
+		std::memset(static_cast<void*>(memory), pattern, count * sizeof(T));
+		return memory;
+	}
+
+	void deallocate(T* memory, const size_t count)
+	{
+		std::allocator<T>{}.deallocate(memory, count);
+	}
+
+	friend bool operator==(const pattern_allocator&, const pattern_allocator&) { return true; }
+	friend bool operator!=(const pattern_allocator&, const pattern_allocator&) { return false; }
+};
+
+// Tracks the bytes all its copies have handed out and not taken back yet
+template <class T>
+struct counting_allocator
+{
+	using value_type = T;
+
+	static size_t& live_bytes()
+	{
+		static size_t bytes = 0;
+		return bytes;
+	}
+
+	counting_allocator() = default;
+
+	template <class U>
+	counting_allocator(const counting_allocator<U>&) {}
+
+	T* allocate(const size_t count)
+	{
+		live_bytes() += count * sizeof(T);
+		return std::allocator<T>{}.allocate(count);
+	}
+
+	void deallocate(T* memory, const size_t count)
+	{
+		live_bytes() -= count * sizeof(T);
+		std::allocator<T>{}.deallocate(memory, count);
+	}
+
+	friend bool operator==(const counting_allocator&, const counting_allocator&) { return true; }
+	friend bool operator!=(const counting_allocator&, const counting_allocator&) { return false; }
+};
+
+TEST(DMatrix_ConstructionTest, T_010_Uninitialized)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = unsigned char;
+		using matrix_type = DMatrix<test_type, pattern_allocator<test_type>>;
+		const test_data<test_type> test_data{ 3, 4 };
+
+		const matrix_type uninitialized_matrix(test_data.rows, test_data.columns, uninitialized);
+		EXPECT_EQ(uninitialized_matrix.rows(), test_data.rows);
+		EXPECT_EQ(uninitialized_matrix.columns(), test_data.columns);
+		EXPECT_EQ(uninitialized_matrix.size(), test_data.size);
+		EXPECT_THAT(uninitialized_matrix, ::testing::Each(pattern_allocator<test_type>::pattern));
+
+		// The regular constructor still zero fills
+		const matrix_type matrix(test_data.rows, test_data.columns);
+		EXPECT_THAT(matrix, ::testing::Each(0));
+
+		const matrix_type source{ 2, 3, {1,2,3,4,5,6} };
+		EXPECT_THAT(source.transpose(), ::testing::ElementsAre(1, 4, 2, 5, 3, 6));
+		EXPECT_THAT(source.splice({ 0, 1, 2, 2 }), ::testing::ElementsAre(2, 3, 5, 6));
+		EXPECT_THAT(source * source.transpose(), ::testing::ElementsAre(14, 32, 32, 77));
+		EXPECT_THAT(matrix_type{ source + source }, ::testing::ElementsAre(2, 4, 6, 8, 10, 12));
+	}
+}
+
 TEST(DMatrix_AtTest, T_001_IndexNonConst)
 {
 	using namespace PrimMatrix;
@@ -846,6 +946,41 @@ TEST(DMatrix_OperatorTests, T_005_MultiplicationEqualsOperator)
 			EXPECT_EQ(e.rhs_columns(), matrix_diff_columns.columns());
 		}
 	}
+
+	{
+		using test_type = double;
+		using size_type = DMatrix<test_type>::size_type;
+
+		// Small and large products, padded results get zeroed padding
+		for (const size_type size : { size_type{ 30 }, size_type{ 760 } })
+		{
+			DMatrix<test_type> matrix{ size, size - 7, Padding{} };
+			DMatrix<test_type> rhs{ size - 7, size - 3 };
+			for (size_type row = 0; row < matrix.rows(); ++row)
+			{
+				for (size_type column = 0; column < matrix.columns(); ++column)
+				{
+					matrix(row, column) = static_cast<test_type>((row + column) % 5);
+				}
+			}
+
+			for (size_type i = 0; i < rhs.size(); ++i)
+			{
+				rhs[i] = static_cast<test_type>(i % 3);
+			}
+
+			const DMatrix<test_type> expected = matrix * rhs;
+			matrix *= rhs;
+			EXPECT_TRUE(matrix == expected);
+			EXPECT_EQ(matrix.columns(), size - 3);
+
+			for (size_type row = 0; row < matrix.rows(); ++row)
+			{
+				const test_type* const padding = matrix.data() + row * matrix.leading_dimension() + matrix.columns();
+				EXPECT_TRUE(std::all_of(padding, padding + matrix.leading_dimension() - matrix.columns(), [](const test_type value) { return value == 0.0; }));
+			}
+		}
+	}
 }
 
 TEST(DMatrix_OperatorTests, T_006_ScalarMultiplicationOperator)
@@ -913,111 +1048,2185 @@ TEST(DMatrix_OperatorTests, T_008_EqualsAndNotEqualsOperator)
 }
 
 
-TEST(DMatrix_Operations, T_001_Transpose)
+TEST(DMatrix_OperatorTests, T_009_MultiplicationOperatorBlocked)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = long long;
+		using size_type = DMatrix<test_type>::size_type;
+
+		// Sizes above the engine threshold and not multiples of any tile size
+		DMatrix<test_type> m1{ 131, 300 };
+		DMatrix<test_type> m2{ 300, 75 };
+		for (size_type i = 0; i < m1.size(); ++i)
+		{
+			m1[i] = static_cast<test_type>(i % 17) - 8;
+		}
+
+		for (size_type i = 0; i < m2.size(); ++i)
+		{
+			m2[i] = static_cast<test_type>(i % 13) - 6;
+		}
+
+		DMatrix<test_type> expected{ m1.rows(), m2.columns() };
+		for (size_type row = 0; row < expected.rows(); ++row)
+		{
+			for (size_type column = 0; column < expected.columns(); ++column)
+			{
+				for (size_type sum_index = 0; sum_index < m1.columns(); ++sum_index)
+				{
+					expected(row, column) += m1(row, sum_index) * m2(sum_index, column);
+				}
+			}
+		}
+
+		const DMatrix<test_type> multiplication_result = m1 * m2;
+		EXPECT_EQ(multiplication_result.rows(), expected.rows());
+		EXPECT_EQ(multiplication_result.columns(), expected.columns());
+		EXPECT_TRUE(multiplication_result == expected);
+
+		m1 *= m2;
+		EXPECT_TRUE(m1 == expected);
+	}
+}
+
+TEST(DMatrix_OperatorTests, T_010_MultiplicationOperatorParallel)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = long long;
+		using size_type = DMatrix<test_type>::size_type;
+
+		ThreadPool::instance().resize(3);
+
+		DMatrix<test_type> m1{ 203, 150 };
+		DMatrix<test_type> m2{ 150, 171 };
+		for (size_type i = 0; i < m1.size(); ++i)
+		{
+			m1[i] = static_cast<test_type>(i % 11) - 5;
+		}
+
+		for (size_type i = 0; i < m2.size(); ++i)
+		{
+			m2[i] = static_cast<test_type>(i % 7) - 3;
+		}
+
+		DMatrix<test_type> expected{ m1.rows(), m2.columns() };
+		detail::gemm_naive(
+			m1.rows(), m2.columns(), m1.columns(),
+			m1.data(), m1.columns(), size_type{ 1 },
+			m2.data(), m2.columns(), size_type{ 1 },
+			expected.data(), expected.columns(), size_type{ 1 });
+
+		EXPECT_TRUE(m1 * m2 == expected);
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+TEST(DMatrix_ExpressionTests, T_001_ElementwiseChain)
 {
 	using namespace PrimMatrix;
 
 	{
 		using test_type = int;
-		const test_data<test_type> test_data{ 5, 2 };
 
-		const std::vector<test_type> vec{ 1,2,3,4,5,6,7,8,9,10 };
+		const DMatrix<test_type> a{ 2, 3, {1,2,3,4,5,6} };
+		const DMatrix<test_type> b{ 2, 3, {6,5,4,3,2,1} };
+		const DMatrix<test_type> c{ 2, 3, {1,1,2,2,3,3} };
 
-		const DMatrix<test_type> matrix(test_data.rows, test_data.columns, vec);
-		const DMatrix<test_type> transposed = matrix.transpose();
+		// Operators build a lazy expression, nothing is evaluated until it is assigned to a matrix
+		const auto expression = a + b - c * 2;
+		EXPECT_FALSE((std::is_same<std::decay_t<decltype(expression)>, DMatrix<test_type>>::value));
+		EXPECT_EQ(expression.rows(), 2);
+		EXPECT_EQ(expression.columns(), 3);
+		EXPECT_EQ(expression(1, 2), 1);
 
-		EXPECT_EQ(transposed.rows(), test_data.columns);
-		EXPECT_EQ(transposed.columns(), test_data.rows);
-		EXPECT_EQ(transposed.size(), test_data.size);
+		const DMatrix<test_type> result = expression;
+		EXPECT_THAT(result, ::testing::ElementsAre(5, 5, 3, 3, 1, 1));
 
-		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 3, 5, 7, 9, 2, 4, 6, 8, 10));
+		const DMatrix<test_type> scaled = 2 * (a - b) * 3;
+		EXPECT_THAT(scaled, ::testing::ElementsAre(-30, -18, -6, 6, 18, 30));
 	}
 
 	{
 		using test_type = int;
-		const test_data<test_type> test_data{ 2, 5 };
 
-		const std::vector<test_type> vec{ 1,2,3,4,5,6,7,8,9,10 };
+		const DMatrix<test_type> a{ 2, 2, {1,2,3,4} };
+		DMatrix<test_type> result{ 2, 2, {1,1,1,1} };
+		const test_type* const storage = result.data();
 
-		const DMatrix<test_type> matrix(test_data.rows, test_data.columns, vec);
-		const DMatrix<test_type> transposed = matrix.transpose();
+		// Same size, the storage is reused and the matrix may appear on both sides
+		result = result + a * 2 - a;
+		EXPECT_THAT(result, ::testing::ElementsAre(2, 3, 4, 5));
+		EXPECT_EQ(result.data(), storage);
 
-		EXPECT_EQ(transposed.rows(), test_data.columns);
-		EXPECT_EQ(transposed.columns(), test_data.rows);
-		EXPECT_EQ(transposed.size(), test_data.size);
+		result += a * 10;
+		EXPECT_THAT(result, ::testing::ElementsAre(12, 23, 34, 45));
 
-		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 6, 2, 7, 3, 8, 4, 9, 5, 10));
+		result -= a + a;
+		EXPECT_THAT(result, ::testing::ElementsAre(10, 19, 28, 37));
+
+		DMatrix<test_type> resized{ 1, 1 };
+		resized = a + a;
+		EXPECT_EQ(resized.rows(), 2);
+		EXPECT_EQ(resized.columns(), 2);
+		EXPECT_THAT(resized, ::testing::ElementsAre(2, 4, 6, 8));
+
+		const DMatrix<test_type> product = (a + a) * a;
+		EXPECT_THAT(product, ::testing::ElementsAre(14, 20, 30, 44));
 	}
 }
 
-TEST(DMatrix_Operations, T_002_CreateIdentityMatrix)
+TEST(DMatrix_ExpressionTests, T_002_SizeMismatch)
 {
 	using namespace PrimMatrix;
 
 	{
 		using test_type = int;
-		const DMatrix<test_type>::value_type size = 3;
-		const auto identity_matrix = DMatrix<test_type>::create_identity_matrix(size);
 
-		EXPECT_EQ(identity_matrix.rows(), size);
-		EXPECT_EQ(identity_matrix.columns(), size);
-		EXPECT_EQ(identity_matrix.size(), size * size);
+		const DMatrix<test_type> a{ 2, 3, {1,2,3,4,5,6} };
+		const DMatrix<test_type> b{ 2, 3, {6,5,4,3,2,1} };
+		const DMatrix<test_type> c{ 3, 2, {1,1,2,2,3,3} };
 
-		EXPECT_THAT(identity_matrix, ::testing::ElementsAre(1, 0, 0, 0, 1, 0, 0, 0, 1));
+		try
+		{
+			const DMatrix<test_type> result = a + b - c * 2;
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::subtraction);
+			EXPECT_EQ(e.lhs_rows(), a.rows());
+			EXPECT_EQ(e.lhs_columns(), a.columns());
+			EXPECT_EQ(e.rhs_rows(), c.rows());
+			EXPECT_EQ(e.rhs_columns(), c.columns());
+		}
+
+		DMatrix<test_type> result{ 2, 3 };
+		try
+		{
+			result += c * 2;
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::addition);
+		}
 	}
+}
 
+TEST(DMatrix_ExpressionTests, T_003_RvalueOperandsReuseStorage)
+{
+	using namespace PrimMatrix;
 
 	{
 		using test_type = int;
-		const DMatrix<test_type>::value_type size = 1;
-		const auto identity_matrix = DMatrix<test_type>::create_identity_matrix(size);
 
-		EXPECT_EQ(identity_matrix.rows(), size);
-		EXPECT_EQ(identity_matrix.columns(), size);
-		EXPECT_EQ(identity_matrix.size(), size * size);
+		const DMatrix<test_type> a{ 2, 2, {1,2,3,4} };
+
+		DMatrix<test_type> lhs_temporary{ 2, 2, {10,20,30,40} };
+		const test_type* storage = lhs_temporary.data();
+		const DMatrix<test_type> sum = std::move(lhs_temporary) + a;
+		EXPECT_THAT(sum, ::testing::ElementsAre(11, 22, 33, 44));
+		EXPECT_EQ(sum.data(), storage);
+
+		DMatrix<test_type> rhs_temporary{ 2, 2, {10,20,30,40} };
+		storage = rhs_temporary.data();
+		const DMatrix<test_type> difference = a - std::move(rhs_temporary);
+		EXPECT_THAT(difference, ::testing::ElementsAre(-9, -18, -27, -36));
+		EXPECT_EQ(difference.data(), storage);
+
+		DMatrix<test_type> scaled_temporary{ 2, 2, {1,2,3,4} };
+		storage = scaled_temporary.data();
+		const DMatrix<test_type> scaled = 3 * std::move(scaled_temporary);
+		EXPECT_THAT(scaled, ::testing::ElementsAre(3, 6, 9, 12));
+		EXPECT_EQ(scaled.data(), storage);
+
+		DMatrix<test_type> square_temporary{ 2, 2, {1,2,3,4} };
+		storage = square_temporary.data();
+		const DMatrix<test_type> transposed = std::move(square_temporary).transpose();
+		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 3, 2, 4));
+		EXPECT_EQ(transposed.data(), storage);
+
+		DMatrix<test_type> rectangular_temporary{ 2, 3, {1,2,3,4,5,6} };
+		const DMatrix<test_type> transposed_rectangular = std::move(rectangular_temporary).transpose();
+		EXPECT_THAT(transposed_rectangular, ::testing::ElementsAre(1, 4, 2, 5, 3, 6));
+
+		// Products are temporaries too, the chain below only allocates for the two products
+		const DMatrix<test_type> chained = a * a + a * a - a * 2;
+		EXPECT_THAT(chained, ::testing::ElementsAre(12, 16, 24, 36));
+	}
 
-		EXPECT_THAT(identity_matrix, ::testing::ElementsAre(1));
+	{
+		using test_type = int;
+
+		DMatrix<test_type> a{ 2, 2, {1,2,3,4} };
+		const DMatrix<test_type> identity = DMatrix<test_type>::create_identity_matrix(2);
+		const test_type* const storage = a.data();
+
+		// The scratch buffer and the storage trade places, so a second product lands back in the original storage
+		a *= identity;
+		a *= identity;
+		EXPECT_THAT(a, ::testing::ElementsAre(1, 2, 3, 4));
+		EXPECT_EQ(a.data(), storage);
+
+		a *= a;
+		EXPECT_THAT(a, ::testing::ElementsAre(7, 10, 15, 22));
+	}
+
+	{
+		using test_type = double;
+		using matrix_type = DMatrix<test_type, counting_allocator<test_type>>;
+
+		// Storage above the scratch size is freed once a product replaces it, the thread keeps nothing of it
+		const size_t size = 200;
+		ASSERT_GT(size * size * sizeof(test_type), detail::multiplication_scratch_bytes);
+
+		matrix_type a{ size, size, 1.0 };
+		const matrix_type identity = matrix_type::create_identity_matrix(size);
+		const size_t live_bytes = counting_allocator<test_type>::live_bytes();
+
+		a *= identity;
+		EXPECT_EQ(counting_allocator<test_type>::live_bytes(), live_bytes);
+		EXPECT_TRUE(std::all_of(a.begin(), a.end(), [](const test_type value) { return value == 1.0; }));
 	}
 }
 
-TEST(DMatrix_Operations, T_003_Splice)
+TEST(DMatrix_ExpressionTests, T_004_SelfReferencingOperands)
 {
 	using namespace PrimMatrix;
 
 	{
 		using test_type = int;
-		const DMatrix<test_type> matrix{ 3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12} };
-		
-		const auto spliced = matrix.splice({ 1, 2, 2, 2 });
 
-		EXPECT_THAT(spliced, ::testing::ElementsAre(7, 8, 11, 12));
+		const DMatrix<test_type> original{ 3, 3, {0,1,2,3,4,5,6,7,8} };
+		const DMatrix<test_type> zeros{ 3, 3 };
+
+		DMatrix<test_type> matrix = original;
+		matrix = matrix.t() + zeros;
+		EXPECT_THAT(matrix, ::testing::ElementsAre(0, 3, 6, 1, 4, 7, 2, 5, 8));
+
+		matrix = original;
+		matrix = matrix.t();
+		EXPECT_TRUE(matrix == original.transpose());
+
+		matrix = original;
+		matrix = matrix.t() * 2 - matrix;
+		EXPECT_TRUE(matrix == original.transpose() * 2 - original);
+
+		// A padded matrix keeps its padding when it has to be evaluated into fresh storage
+		DMatrix<test_type> padded{ 3, 3, Padding{} };
+		padded = original;
+		const DMatrix<test_type>::size_type leading_dimension = padded.leading_dimension();
+		padded = padded.t() + padded;
+		EXPECT_TRUE(padded == original.transpose() + original);
+		EXPECT_EQ(padded.leading_dimension(), leading_dimension);
+	}
+
+	{
+		using test_type = int;
+
+		const DMatrix<test_type> original{ 4, 4, {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15} };
+
+		// Shifted windows of the same storage
+		DMatrix<test_type> matrix = original;
+		matrix.view({ 1, 1, 3, 3 }) = matrix.view({ 0, 0, 3, 3 });
+		EXPECT_TRUE(DMatrix<test_type>{ matrix.view({ 1, 1, 3, 3 }) } == original.splice({ 0, 0, 3, 3 }));
+
+		matrix = original;
+		matrix.view({ 0, 0, 3, 3 }) = matrix.view({ 1, 1, 3, 3 });
+		EXPECT_TRUE(DMatrix<test_type>{ matrix.view({ 0, 0, 3, 3 }) } == original.splice({ 1, 1, 3, 3 }));
+
+		matrix = original;
+		matrix.view() = matrix.t();
+		EXPECT_TRUE(matrix == original.transpose());
+
+		// The same window on both sides is still assigned in place
+		matrix = original;
+		matrix.view({ 1, 0, 2, 4 }) += matrix.view({ 1, 0, 2, 4 });
+		EXPECT_THAT(matrix, ::testing::ElementsAre(0, 1, 2, 3, 8, 10, 12, 14, 16, 18, 20, 22, 12, 13, 14, 15));
+	}
+}
+
+TEST(DMatrix_GemmTests, T_001_AlphaBeta)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+
+		const DMatrix<test_type> m1{ 2, 3, {1,2,3,4,5,6} };
+		const DMatrix<test_type> m2{ 3, 2, {1,2,3,4,5,6} };
+		DMatrix<test_type> result{ 2, 2, {1,1,1,1} };
+
+		gemm(2, m1, m2, 3, result);
+		EXPECT_THAT(result, ::testing::ElementsAre(47, 59, 101, 131));
+
+		gemm(1, m1, m2, 0, result);
+		EXPECT_THAT(result, ::testing::ElementsAre(22, 28, 49, 64));
+	}
+
+	{
+		using test_type = double;
+		using size_type = DMatrix<test_type>::size_type;
+
+		DMatrix<test_type> m1{ 90, 310 };
+		DMatrix<test_type> m2{ 310, 70 };
+		DMatrix<test_type> accumulator{ 90, 70 };
+		for (size_type i = 0; i < m1.size(); ++i)
+		{
+			m1[i] = static_cast<test_type>(i % 9) - 4;
+		}
+
+		for (size_type i = 0; i < m2.size(); ++i)
+		{
+			m2[i] = static_cast<test_type>(i % 5) - 2;
+		}
+
+		for (size_type i = 0; i < accumulator.size(); ++i)
+		{
+			accumulator[i] = static_cast<test_type>(i % 3);
+		}
+
+		const DMatrix<test_type> expected = m1 * m2 * 0.5 + accumulator * 2.0;
+
+		gemm(0.5, m1, m2, 2.0, accumulator);
+		EXPECT_TRUE(accumulator == expected);
+	}
+
+	{
+		using test_type = int;
+
+		const DMatrix<test_type> m1{ 2, 3, {1,2,3,4,5,6} };
+		const DMatrix<test_type> m2{ 3, 2, {1,2,3,4,5,6} };
+		DMatrix<test_type> result_wrong_size{ 2, 3 };
 
-		const Splice splice_row_out_of_bounds{ 1, 2, 3, 2 };
-		const Splice splice_column_out_of_bounds{ 1, 2, 2, 3 };
 		try
 		{
-			matrix.splice(splice_row_out_of_bounds);
+			gemm(1, m1, m2, 0, result_wrong_size);
 
 			EXPECT_TRUE(false);
 		}
-		catch(const Matrix_SpliceOutOfBounds& e)
+		catch (const Matrix_OperationMatrixMismatch& e)
 		{
-			EXPECT_EQ(e.splice(), splice_row_out_of_bounds);
-			EXPECT_EQ(e.matrix_rows(), matrix.rows());
-			EXPECT_EQ(e.matrix_columns(), matrix.columns());
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::addition);
+			EXPECT_EQ(e.lhs_rows(), result_wrong_size.rows());
+			EXPECT_EQ(e.lhs_columns(), result_wrong_size.columns());
+			EXPECT_EQ(e.rhs_rows(), m1.rows());
+			EXPECT_EQ(e.rhs_columns(), m2.columns());
 		}
 
 		try
 		{
-			matrix.splice(splice_column_out_of_bounds);
+			gemm(1, m1, m1, 0, result_wrong_size);
 
 			EXPECT_TRUE(false);
 		}
-		catch (const Matrix_SpliceOutOfBounds& e)
+		catch (const Matrix_OperationMatrixMismatch& e)
 		{
-			EXPECT_EQ(e.splice(), splice_column_out_of_bounds);
-			EXPECT_EQ(e.matrix_rows(), matrix.rows());
-			EXPECT_EQ(e.matrix_columns(), matrix.columns());
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::multiplication);
+		}
+	}
+
+	{
+		using test_type = int;
+
+		DMatrix<test_type> matrix{ 2, 2, {1,2,3,4} };
+
+		gemm(1, matrix, matrix, 1, matrix);
+		EXPECT_THAT(matrix, ::testing::ElementsAre(8, 12, 18, 26));
+	}
+}
+
+TEST(DMatrix_GemmTests, T_002_Epilogues)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+
+		const DMatrix<test_type> m1{ 2, 3, {1,2,3,-4,-5,-6} };
+		const DMatrix<test_type> m2{ 3, 2, {1,2,3,4,5,6} };
+		const DMatrix<test_type> bias{ std::vector<test_type>{ 10, -30 }, DMatrix<test_type>::EOrientation::horizontal };
+		DMatrix<test_type> result{ 2, 2 };
+
+		gemm(1, m1, m2, 0, result, BiasEpilogue<test_type>{ bias });
+		EXPECT_THAT(result, ::testing::ElementsAre(32, -2, -39, -94));
+
+		gemm(1, m1, m2, 0, result, chain_epilogues(BiasEpilogue<test_type>{ bias }, ReluEpilogue{}));
+		EXPECT_THAT(result, ::testing::ElementsAre(32, 0, 0, 0));
+
+		gemm(1, m1, m2, 0, result, ClampEpilogue<test_type>{ -40, 30 });
+		EXPECT_THAT(result, ::testing::ElementsAre(22, 28, -40, -40));
+
+		gemm(1, m1, m2, 0, result, [](const test_type value, const size_t row, const size_t column)
+		{
+			return value * 10 + static_cast<test_type>(row * 2 + column);
+		});
+		EXPECT_THAT(result, ::testing::ElementsAre(220, 281, -488, -637));
+
+		const DMatrix<test_type> bias_wrong_size{ std::vector<test_type>{ 1, 2, 3 }, DMatrix<test_type>::EOrientation::horizontal };
+		try
+		{
+			gemm(1, m1, m2, 0, result, chain_epilogues(ReluEpilogue{}, BiasEpilogue<test_type>{ bias_wrong_size }));
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::addition);
+			EXPECT_EQ(e.rhs_rows(), 1);
+			EXPECT_EQ(e.rhs_columns(), bias_wrong_size.size());
 		}
 	}
-}
\ No newline at end of file
+
+	{
+		using test_type = float;
+		using size_type = DMatrix<test_type>::size_type;
+
+		// Large enough for the blocked and parallel paths, which apply the epilogue per tile
+		ThreadPool::instance().resize(2);
+
+		DMatrix<test_type> m1{ 150, 200 };
+		DMatrix<test_type> m2{ 200, 130 };
+		DMatrix<test_type> bias{ 1, 130 };
+		for (size_type i = 0; i < m1.size(); ++i)
+		{
+			m1[i] = static_cast<test_type>(i % 7) - 3;
+		}
+
+		for (size_type i = 0; i < m2.size(); ++i)
+		{
+			m2[i] = static_cast<test_type>(i % 5) - 2;
+		}
+
+		for (size_type i = 0; i < bias.size(); ++i)
+		{
+			bias[i] = static_cast<test_type>(i) - 65;
+		}
+
+		DMatrix<test_type> expected = m1 * m2;
+		for (size_type row = 0; row < expected.rows(); ++row)
+		{
+			for (size_type column = 0; column < expected.columns(); ++column)
+			{
+				const test_type value = expected(row, column) + bias[column];
+				expected(row, column) = value < 0 ? 0 : value;
+			}
+		}
+
+		DMatrix<test_type> result{ 150, 130 };
+		gemm(1.0f, m1, m2, 0.0f, result, chain_epilogues(BiasEpilogue<test_type>{ bias }, ReluEpilogue{}));
+		EXPECT_TRUE(result == expected);
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+TEST(DMatrix_GemmTests, T_003_Symmetric)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		const DMatrix<test_type> a{ 3, 2, {1, 2, 3, 4, 5, 6} };
+
+		DMatrix<test_type> lower{ 3, 3, -1 };
+		syrk(1, a, 0, lower);
+		EXPECT_THAT(lower, ::testing::ElementsAre(
+			5, -1, -1,
+			11, 25, -1,
+			17, 39, 61));
+
+		DMatrix<test_type> upper{ 3, 3, 1 };
+		syrk(2, a, 1, upper, ETriangle::upper);
+		EXPECT_THAT(upper, ::testing::ElementsAre(
+			11, 23, 35,
+			1, 51, 79,
+			1, 1, 123));
+
+		EXPECT_TRUE(syrk(a) == a * a.transpose());
+		EXPECT_TRUE(syrk(a.t()) == a.transpose() * a);
+
+		const DMatrix<test_type> b{ 3, 2, {1, 0, 0, 1, 2, -1} };
+		EXPECT_TRUE(symm(lower, ETriangle::lower, b) == syrk(a) * b);
+		EXPECT_TRUE(symm(lower.t(), ETriangle::upper, b) == syrk(a) * b);
+
+		try
+		{
+			syrk(1, a, 0, lower.view({ 0, 0, 3, 2 }));
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::addition);
+		}
+
+		try
+		{
+			symm(a, ETriangle::lower, b);
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::multiplication);
+		}
+	}
+
+	{
+		using test_type = double;
+
+		DMatrix<test_type> samples{ 300, 150 };
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			samples[i] = static_cast<test_type>(static_cast<int>(i % 23) - 11);
+		}
+
+		const DMatrix<test_type> expected = samples * samples.transpose();
+		EXPECT_TRUE(syrk(samples) == expected);
+
+		for (const ETriangle triangle : { ETriangle::lower, ETriangle::upper })
+		{
+			DMatrix<test_type> row_major{ 300, 300, test_type{ -1 } };
+			DMatrix<test_type, std::allocator<test_type>, ColumnMajor> column_major{ 300, 300, test_type{ -1 } };
+			syrk(test_type{ 1 }, samples, test_type{}, row_major, triangle);
+			syrk(test_type{ 1 }, samples, test_type{}, column_major, triangle);
+
+			for (size_t row = 0; row < 300; ++row)
+			{
+				for (size_t column = 0; column < 300; ++column)
+				{
+					const bool computed = triangle == ETriangle::lower ? column <= row : column >= row;
+					const test_type value = computed ? expected(row, column) : test_type{ -1 };
+					EXPECT_EQ(row_major(row, column), value);
+					EXPECT_EQ(column_major(row, column), value);
+				}
+			}
+
+			const DMatrix<test_type> rhs = samples.splice({ 0, 0, 300, 70 });
+			EXPECT_TRUE(symm(row_major, triangle, rhs) == expected * rhs);
+			EXPECT_TRUE(symm(column_major, triangle, rhs) == expected * rhs);
+
+			DMatrix<test_type> mirrored{ 300, 300, uninitialized, Padding{} };
+			syrk(test_type{ 1 }, samples, test_type{}, mirrored, triangle, ESymmetricFill::full);
+			EXPECT_TRUE(mirrored == expected);
+		}
+	}
+}
+
+TEST(DMatrix_GemmTests, T_004_MatrixVector)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		const DMatrix<test_type> matrix{ 2, 3, {1, 2, 3, 4, 5, 6} };
+		const DMatrix<test_type> column{ std::vector<test_type>{ 1, 0, -1 }, DMatrix<test_type>::EOrientation::vertical };
+		const DMatrix<test_type> row{ std::vector<test_type>{ 2, -1 }, DMatrix<test_type>::EOrientation::horizontal };
+
+		EXPECT_THAT(matrix * column, ::testing::ElementsAre(-2, -2));
+		EXPECT_THAT(row * matrix, ::testing::ElementsAre(-2, -1, 0));
+		EXPECT_THAT(matrix.t() * row.t(), ::testing::ElementsAre(-2, -1, 0));
+
+		const DMatrix<test_type, std::allocator<test_type>, ColumnMajor> column_major{ matrix };
+		EXPECT_THAT(column_major * column, ::testing::ElementsAre(-2, -2));
+		EXPECT_THAT(row * column_major, ::testing::ElementsAre(-2, -1, 0));
+
+		// A column of a row-major matrix is a strided vector
+		EXPECT_THAT(matrix.t() * matrix.view({ 0, 1, 2, 1 }), ::testing::ElementsAre(22, 29, 36));
+
+		DMatrix<test_type> result{ 2, 1, 10 };
+		const DMatrix<test_type> bias{ std::vector<test_type>{ 100 }, DMatrix<test_type>::EOrientation::horizontal };
+		gemm(2, matrix, column, 1, result, BiasEpilogue<test_type>{ bias });
+		EXPECT_THAT(result, ::testing::ElementsAre(106, 106));
+
+		DMatrix<test_type> row_result{ 1, 3, 1 };
+		const DMatrix<test_type> row_bias{ std::vector<test_type>{ 10, 20, 30 }, DMatrix<test_type>::EOrientation::horizontal };
+		gemm(1, row, matrix, 2, row_result, BiasEpilogue<test_type>{ row_bias });
+		EXPECT_THAT(row_result, ::testing::ElementsAre(10, 21, 32));
+	}
+
+	{
+		using test_type = double;
+
+		DMatrix<test_type> matrix{ 900, 700 };
+		for (size_t i = 0; i < matrix.size(); ++i)
+		{
+			matrix[i] = static_cast<test_type>(static_cast<int>(i % 23) - 11);
+		}
+
+		DMatrix<test_type> column{ 700, 1 };
+		DMatrix<test_type> row{ 1, 900 };
+		for (size_t i = 0; i < column.size(); ++i)
+		{
+			column[i] = static_cast<test_type>(static_cast<int>(i % 7) - 3);
+		}
+		for (size_t i = 0; i < row.size(); ++i)
+		{
+			row[i] = static_cast<test_type>(static_cast<int>(i % 5) - 2);
+		}
+
+		DMatrix<test_type> expected_column{ 900, 1 };
+		for (size_t i = 0; i < 900; ++i)
+		{
+			for (size_t p = 0; p < 700; ++p)
+			{
+				expected_column[i] += matrix(i, p) * column[p];
+			}
+		}
+
+		DMatrix<test_type> expected_row{ 1, 700 };
+		for (size_t p = 0; p < 900; ++p)
+		{
+			for (size_t j = 0; j < 700; ++j)
+			{
+				expected_row[j] += row[p] * matrix(p, j);
+			}
+		}
+
+		const DMatrix<test_type, std::allocator<test_type>, ColumnMajor> column_major{ matrix };
+
+		for (const size_t workers : { size_t{ 0 }, size_t{ 3 } })
+		{
+			ThreadPool::instance().resize(workers);
+
+			EXPECT_TRUE(matrix * column == expected_column);
+			EXPECT_TRUE(column_major * column == expected_column);
+			EXPECT_TRUE(row * matrix == expected_row);
+			EXPECT_TRUE(row * column_major == expected_row);
+		}
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+TEST(DMatrix_ViewTests, T_001_View)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		DMatrix<test_type> matrix{ 3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12} };
+
+		const MatrixView<test_type> view = matrix.view({ 1, 1, 2, 3 });
+		EXPECT_EQ(view.rows(), 2);
+		EXPECT_EQ(view.columns(), 3);
+		EXPECT_EQ(view.size(), 6);
+		EXPECT_EQ(view.leading_dimension(), matrix.columns());
+		EXPECT_EQ(view.data(), matrix.data() + 5);
+		EXPECT_THAT(view, ::testing::ElementsAre(6, 7, 8, 10, 11, 12));
+		EXPECT_THAT(view.view({ 1, 1, 1, 2 }), ::testing::ElementsAre(11, 12));
+
+		view(0, 0) = 60;
+		EXPECT_EQ(matrix(1, 1), 60);
+		EXPECT_EQ(view.at(1, 2), 12);
+
+		const DMatrix<test_type> block{ 2, 2, {-1, -2, -3, -4} };
+		matrix.view({ 0, 2, 2, 2 }) = block;
+		EXPECT_THAT(matrix, ::testing::ElementsAre(1, 2, -1, -2, 5, 60, -3, -4, 9, 10, 11, 12));
+
+		matrix.view({ 2, 0, 1, 4 }) *= 2;
+		EXPECT_THAT(matrix.view({ 2, 0, 1, 4 }), ::testing::ElementsAre(18, 20, 22, 24));
+
+		const ConstMatrixView<test_type> whole = static_cast<const DMatrix<test_type>&>(matrix).view();
+		EXPECT_THAT(whole, ::testing::ElementsAreArray(matrix.begin(), matrix.end()));
+		EXPECT_THAT(matrix.view({ 1, 4, 2, 0 }), ::testing::ElementsAre());
+
+		try
+		{
+			view.at(2, 0);
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_RowColOutOfBounds& e)
+		{
+			EXPECT_EQ(e.matrix_rows(), view.rows());
+			EXPECT_EQ(e.matrix_columns(), view.columns());
+		}
+
+		const Splice splice_out_of_bounds{ 1, 2, 2, 3 };
+		try
+		{
+			matrix.view(splice_out_of_bounds);
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_SpliceOutOfBounds& e)
+		{
+			EXPECT_EQ(e.splice(), splice_out_of_bounds);
+			EXPECT_EQ(e.matrix_rows(), matrix.rows());
+			EXPECT_EQ(e.matrix_columns(), matrix.columns());
+		}
+
+		try
+		{
+			matrix.view({ 0, 0, 2, 2 }) = matrix;
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::assignment);
+		}
+	}
+}
+
+TEST(DMatrix_ViewTests, T_002_ViewOperands)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		const DMatrix<test_type> matrix{ 3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12} };
+		const auto left = matrix.view({ 0, 0, 2, 2 });
+		const auto right = matrix.view({ 1, 2, 2, 2 });
+
+		const DMatrix<test_type> sum = left + right;
+		EXPECT_THAT(sum, ::testing::ElementsAre(8, 10, 16, 18));
+
+		const DMatrix<test_type> difference = right - left * 2;
+		EXPECT_THAT(difference, ::testing::ElementsAre(5, 4, 1, 0));
+
+		DMatrix<test_type> accumulator{ 2, 2, 1 };
+		accumulator += right;
+		EXPECT_THAT(accumulator, ::testing::ElementsAre(8, 9, 12, 13));
+
+		const DMatrix<test_type> product = left * right;
+		EXPECT_THAT(product, ::testing::ElementsAre(29, 32, 101, 112));
+
+		const DMatrix<test_type> mixed_product = matrix.view({ 0, 1, 3, 2 }).view({ 0, 0, 2, 2 }) * (matrix.splice({ 0, 0, 2, 2 }) + left);
+		EXPECT_THAT(mixed_product, ::testing::ElementsAre(34, 44, 82, 108));
+	}
+
+	{
+		using test_type = int;
+		const DMatrix<test_type> m1{ 2, 3, {1,2,3,4,5,6} };
+		const DMatrix<test_type> m2{ 3, 2, {7,8,9,10,11,12} };
+		DMatrix<test_type> result{ 4, 5, -1 };
+
+		gemm(1, m1, m2, 0, result.view({ 1, 2, 2, 2 }));
+		EXPECT_THAT(result, ::testing::ElementsAre(
+			-1, -1, -1, -1, -1,
+			-1, -1, 58, 64, -1,
+			-1, -1, 139, 154, -1,
+			-1, -1, -1, -1, -1));
+
+		gemm(1, result.view({ 1, 2, 2, 2 }), m2.view({ 0, 0, 2, 2 }), 1, result.view({ 1, 2, 2, 2 }));
+		EXPECT_THAT(result.view({ 1, 2, 2, 2 }), ::testing::ElementsAre(58 + 982, 64 + 1104, 139 + 2359, 154 + 2652));
+
+		try
+		{
+			gemm(1, m1, m2, 0, result.view({ 0, 0, 3, 2 }));
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_OperationMatrixMismatch& e)
+		{
+			EXPECT_EQ(e.operation(), Matrix_OperationMatrixMismatch::EOperation::addition);
+		}
+	}
+
+	{
+		using test_type = double;
+
+		DMatrix<test_type> big{ 200, 180 };
+		for (size_t i = 0; i < big.size(); ++i)
+		{
+			big[i] = static_cast<test_type>(static_cast<int>(i % 23) - 11);
+		}
+
+		const auto lhs = big.view({ 3, 5, 150, 100 });
+		const auto rhs = big.view({ 50, 70, 100, 90 });
+		const DMatrix<test_type> expected = DMatrix<test_type>{ lhs } * DMatrix<test_type>{ rhs };
+
+		EXPECT_TRUE(lhs * rhs == expected);
+	}
+}
+
+TEST(DMatrix_ViewTests, T_003_TransposedViews)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		DMatrix<test_type> matrix{ 2, 3, {1, 2, 3, 4, 5, 6} };
+		const auto transposed = matrix.t();
+
+		EXPECT_EQ(transposed.rows(), 3);
+		EXPECT_EQ(transposed.columns(), 2);
+		EXPECT_EQ(transposed.data(), matrix.data());
+		EXPECT_TRUE(DMatrix<test_type>{ transposed } == matrix.transpose());
+		EXPECT_TRUE(DMatrix<test_type>{ transposed.t() } == matrix);
+
+		matrix.t()(2, 1) = 60;
+		EXPECT_EQ(matrix(1, 2), 60);
+		matrix(1, 2) = 6;
+
+		const DMatrix<test_type> m2{ 2, 2, {7, 8, 9, 10} };
+		const DMatrix<test_type> tn = matrix.t() * m2;
+		EXPECT_TRUE(tn == matrix.transpose() * m2);
+
+		const DMatrix<test_type> m3{ 4, 3, {1, 0, 2, 0, 1, 0, 3, 1, 1, 2, 2, 2} };
+		const DMatrix<test_type> nt = matrix * m3.t();
+		EXPECT_TRUE(nt == matrix * m3.transpose());
+
+		const DMatrix<test_type> tt = matrix.t() * m2.t();
+		EXPECT_TRUE(tt == matrix.transpose() * m2.transpose());
+
+		// Products with a transposed operand stay row-major, a Gram matrix is not converted on assignment
+		EXPECT_TRUE((std::is_same<decltype(matrix.t() * m2), DMatrix<test_type>>::value));
+		EXPECT_TRUE((std::is_same<decltype(matrix.t() * matrix), DMatrix<test_type>>::value));
+		EXPECT_TRUE((std::is_same<decltype(m3 * matrix.t()), DMatrix<test_type>>::value));
+		EXPECT_TRUE((std::is_same<decltype(matrix.t() * m2.t()), DMatrix<test_type, std::allocator<test_type>, ColumnMajor>>::value));
+
+		const auto gram = matrix.t() * matrix;
+		EXPECT_TRUE(gram == matrix.transpose() * matrix);
+	}
+
+	{
+		using test_type = double;
+
+		DMatrix<test_type> lhs{ 70, 90 };
+		DMatrix<test_type> rhs{ 80, 70 };
+		for (size_t i = 0; i < lhs.size(); ++i)
+		{
+			lhs[i] = static_cast<test_type>(static_cast<int>(i % 19) - 9);
+		}
+		for (size_t i = 0; i < rhs.size(); ++i)
+		{
+			rhs[i] = static_cast<test_type>(static_cast<int>(i % 17) - 8);
+		}
+
+		const DMatrix<test_type> lhs_transposed = lhs.transpose();
+		const DMatrix<test_type> rhs_transposed = rhs.transpose();
+
+		EXPECT_TRUE(lhs.t() * rhs_transposed == lhs_transposed * rhs_transposed);
+		EXPECT_TRUE(lhs_transposed * rhs.t() == lhs_transposed * rhs_transposed);
+		EXPECT_TRUE(lhs.t() * rhs.t() == lhs_transposed * rhs_transposed);
+		EXPECT_TRUE(lhs.t().view({ 5, 3, 60, 50 }) * rhs.view({ 10, 7, 50, 40 }) == lhs_transposed.splice({ 5, 3, 60, 50 }) * rhs.splice({ 10, 7, 50, 40 }));
+
+		DMatrix<test_type> result{ 80, 90, test_type{ 1 } };
+		gemm(test_type{ 2 }, lhs.t(), rhs.t(), test_type{ 1 }, result.t());
+
+		const DMatrix<test_type> expected = (rhs * lhs) * test_type{ 2 } + DMatrix<test_type>{ 80, 90, test_type{ 1 } };
+		EXPECT_TRUE(result == expected);
+	}
+}
+
+TEST(DMatrix_StorageOrderTests, T_001_ColumnMajor)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		using column_major = DMatrix<test_type, std::allocator<test_type>, ColumnMajor>;
+
+		const column_major matrix{ 2, 3, {1, 4, 2, 5, 3, 6} };
+		const DMatrix<test_type> row_major{ 2, 3, {1, 2, 3, 4, 5, 6} };
+
+		EXPECT_EQ(matrix.leading_dimension(), 2);
+		EXPECT_EQ(matrix(0, 1), 2);
+		EXPECT_EQ(matrix.at(1, 0), 4);
+		EXPECT_TRUE(matrix == row_major);
+		EXPECT_TRUE(row_major == matrix);
+		EXPECT_FALSE(matrix != row_major);
+
+		const column_major transposed = matrix.transpose();
+		EXPECT_EQ(transposed.rows(), 3);
+		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 2, 3, 4, 5, 6));
+
+		EXPECT_THAT(matrix.view({ 0, 1, 2, 2 }), ::testing::ElementsAre(2, 5, 3, 6));
+		EXPECT_THAT(matrix.splice({ 1, 0, 1, 3 }), ::testing::ElementsAre(4, 5, 6));
+
+		const column_major sum = matrix + row_major;
+		EXPECT_THAT(sum, ::testing::ElementsAre(2, 8, 4, 10, 6, 12));
+
+		const DMatrix<test_type> rhs{ 3, 2, {1, 2, 3, 4, 5, 6} };
+		const column_major product = matrix * rhs;
+		EXPECT_THAT(product, ::testing::ElementsAre(22, 49, 28, 64));
+
+		column_major product_equals{ matrix };
+		product_equals *= column_major{ 3, 2, {1, 3, 5, 2, 4, 6} };
+		EXPECT_TRUE(product_equals == product);
+	}
+
+	{
+		using test_type = double;
+		using column_major = DMatrix<test_type, std::allocator<test_type>, ColumnMajor>;
+
+		DMatrix<test_type> lhs{ 120, 90 };
+		DMatrix<test_type> rhs{ 90, 110 };
+		for (size_t i = 0; i < lhs.size(); ++i)
+		{
+			lhs[i] = static_cast<test_type>(static_cast<int>(i % 17) - 8);
+		}
+		for (size_t i = 0; i < rhs.size(); ++i)
+		{
+			rhs[i] = static_cast<test_type>(static_cast<int>(i % 13) - 6);
+		}
+
+		const column_major lhs_column_major{ lhs };
+		const column_major rhs_column_major{ rhs };
+		const DMatrix<test_type> expected = lhs * rhs;
+
+		EXPECT_TRUE(lhs_column_major * rhs == expected);
+		EXPECT_TRUE(lhs * rhs_column_major == expected);
+		EXPECT_TRUE(lhs_column_major * rhs_column_major == expected);
+
+		const DMatrix<test_type> bias{ std::vector<test_type>(110, 1.0), DMatrix<test_type>::EOrientation::horizontal };
+		column_major result{ 120, 110 };
+		gemm(1.0, lhs, rhs_column_major, 0.0, result, chain_epilogues(BiasEpilogue<test_type>{ bias }, [](const test_type value, const size_t row, const size_t column)
+		{
+			return row == 0 ? static_cast<test_type>(column) : value;
+		}));
+
+		for (size_t column = 0; column < result.columns(); ++column)
+		{
+			EXPECT_EQ(result(0, column), static_cast<test_type>(column));
+			EXPECT_EQ(result(1, column), expected(1, column) + 1.0);
+		}
+	}
+}
+
+TEST(DMatrix_StorageOrderTests, T_002_Padding)
+{
+	using namespace PrimMatrix;
+
+	EXPECT_EQ(padded_leading_dimension<float>(1024), 1040);
+	EXPECT_EQ(padded_leading_dimension<double>(4096), 4104);
+	EXPECT_EQ(padded_leading_dimension<float>(1000), 1008);
+	EXPECT_EQ(padded_leading_dimension<double>(3), 8);
+
+	{
+		using test_type = int;
+
+		DMatrix<test_type> padded{ 3, 4, Padding{ 10 } };
+		const DMatrix<test_type> dense{ 3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12} };
+
+		EXPECT_EQ(padded.leading_dimension(), 10);
+		EXPECT_TRUE(padded.padded());
+		EXPECT_EQ(padded.size(), 12);
+
+		for (size_t i = 0; i < padded.size(); ++i)
+		{
+			padded[i] = static_cast<test_type>(i + 1);
+		}
+
+		EXPECT_EQ(padded(2, 1), 10);
+		EXPECT_EQ(padded.data()[20], 9);
+		EXPECT_EQ(padded.at(11), 12);
+		EXPECT_TRUE(padded == dense);
+		EXPECT_THAT(padded.view({ 1, 1, 2, 2 }), ::testing::ElementsAre(6, 7, 10, 11));
+
+		padded += dense;
+		padded *= 2;
+		EXPECT_THAT(padded, ::testing::ElementsAre(4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48));
+
+		const DMatrix<test_type> sum = padded + dense;
+		EXPECT_THAT(sum, ::testing::ElementsAre(5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60));
+
+		const DMatrix<test_type> transposed = padded.transpose();
+		EXPECT_TRUE(transposed.padded());
+		EXPECT_THAT(transposed, ::testing::ElementsAre(4, 20, 36, 8, 24, 40, 12, 28, 44, 16, 32, 48));
+
+		const DMatrix<test_type> product = padded * transposed;
+		EXPECT_TRUE(product.padded());
+		EXPECT_TRUE(product == dense * dense.transpose() * 16);
+
+		padded *= transposed;
+		EXPECT_EQ(padded.columns(), 3);
+		EXPECT_TRUE(padded == product);
+	}
+
+	{
+		using test_type = float;
+
+		DMatrix<test_type> padded{ 70, 1024, Padding{} };
+		DMatrix<test_type> dense{ 70, 1024 };
+		for (size_t i = 0; i < dense.size(); ++i)
+		{
+			dense[i] = padded[i] = static_cast<test_type>(static_cast<int>(i % 19) - 9);
+		}
+
+		EXPECT_EQ(padded.leading_dimension(), 1040);
+		EXPECT_TRUE(padded * dense.transpose() == dense * dense.transpose());
+		EXPECT_TRUE(padded.transpose() == dense.transpose());
+	}
+}
+
+TEST(DMatrix_ThreadPoolTests, T_001_Run)
+{
+	using namespace PrimMatrix;
+
+	{
+		ThreadPool pool{ 3 };
+		EXPECT_EQ(pool.worker_count(), 3);
+		EXPECT_EQ(pool.concurrency(), 4);
+
+		std::vector<int> hits(1000, 0);
+		pool.run(hits.size(), [&](const size_t task_index) { ++hits[task_index]; });
+		EXPECT_THAT(hits, ::testing::Each(1));
+
+		// The pool is reused, nested runs execute inline
+		std::atomic<int> nested_hits{ 0 };
+		pool.run(8, [&](size_t)
+		{
+			pool.run(4, [&](size_t) { ++nested_hits; });
+		});
+		EXPECT_EQ(nested_hits, 32);
+	}
+
+	{
+		ThreadPool pool{ 2 };
+
+		try
+		{
+			pool.run(16, [](const size_t task_index)
+			{
+				if (task_index == 5)
+				{
+					throw Matrix_Exception{ "task failed" };
+				}
+			});
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_Exception& e)
+		{
+			EXPECT_STREQ(e.what(), "task failed");
+		}
+
+		pool.resize(1, true);
+		EXPECT_EQ(pool.worker_count(), 1);
+		EXPECT_TRUE(pool.pinned());
+
+		std::atomic<int> hits{ 0 };
+		pool.run(10, [&](size_t) { ++hits; });
+		EXPECT_EQ(hits, 10);
+	}
+}
+
+TEST(DMatrix_ThreadPoolTests, T_002_ParallelFor)
+{
+	using namespace PrimMatrix;
+
+	{
+		ThreadPool pool{ 3 };
+
+		std::vector<int> hits(1001, 0);
+		pool.parallel_for(1, hits.size(), 100, [&](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				++hits[i];
+			}
+		});
+
+		EXPECT_EQ(hits[0], 0);
+		EXPECT_THAT(std::vector<int>(hits.begin() + 1, hits.end()), ::testing::Each(1));
+	}
+}
+
+TEST(DMatrix_ThreadPoolTests, T_003_RunAfterResize)
+{
+	using namespace PrimMatrix;
+
+	{
+		ThreadPool pool{ 3 };
+
+		for (size_t worker_count = 1; worker_count <= 4; ++worker_count)
+		{
+			std::atomic<int> before{ 0 };
+			pool.run(64, [&](size_t) { ++before; });
+			EXPECT_EQ(before, 64);
+
+			// Fresh workers must not pick up the finished run
+			pool.resize(worker_count);
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+			EXPECT_EQ(before, 64);
+
+			std::atomic<int> after{ 0 };
+			pool.run(64, [&](size_t) { ++after; });
+			EXPECT_EQ(after, 64);
+			EXPECT_EQ(before, 64);
+
+			std::vector<int> hits(1000, 0);
+			pool.parallel_for(0, hits.size(), 10, [&](const size_t begin, const size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					++hits[i];
+				}
+			});
+			EXPECT_THAT(hits, ::testing::Each(1));
+		}
+
+		// A run right after a resize must wait for every one of its tasks
+		for (int iteration = 0; iteration < 50; ++iteration)
+		{
+			pool.resize(iteration % 3 + 1);
+
+			std::atomic<int> done{ 0 };
+			pool.run(32, [&](size_t)
+			{
+				std::this_thread::yield();
+				++done;
+			});
+			ASSERT_EQ(done, 32);
+		}
+	}
+}
+
+TEST(DMatrix_TaskGraphTests, T_001_Dependencies)
+{
+	using namespace PrimMatrix;
+
+	{
+		ThreadPool pool{ 3 };
+
+		// A diamond followed by a fan-out: every task has to see its prerequisites done
+		std::vector<std::atomic<int>> done(10);
+		std::atomic<int> order_violations{ 0 };
+		TaskGraph graph;
+
+		const auto task = [&](const size_t index, std::vector<size_t> prerequisites)
+		{
+			return graph.add([&, index, prerequisites]
+			{
+				for (const size_t prerequisite : prerequisites)
+				{
+					if (done[prerequisite] == 0)
+					{
+						++order_violations;
+					}
+				}
+
+				++done[index];
+			}, "test task");
+		};
+
+		const TaskGraph::task_id top = task(0, {});
+		const TaskGraph::task_id left = task(1, { 0 });
+		const TaskGraph::task_id right = task(2, { 0 });
+		const TaskGraph::task_id bottom = task(3, { 1, 2 });
+		graph.depend(left, top);
+		graph.depend(right, top);
+		graph.depend(bottom, left);
+		graph.depend(bottom, right);
+		for (size_t index = 4; index < done.size(); ++index)
+		{
+			graph.depend(task(index, { 3 }), bottom);
+		}
+
+		EXPECT_EQ(graph.size(), 10);
+
+		graph.run(pool);
+		EXPECT_EQ(order_violations, 0);
+		for (const auto& count : done)
+		{
+			EXPECT_EQ(count, 1);
+		}
+
+		// Graphs can be rerun, the trace holds every task once in the order they finished
+		const std::vector<TaskTrace> trace = graph.run_traced(pool);
+		EXPECT_EQ(order_violations, 0);
+		ASSERT_EQ(trace.size(), graph.size());
+		EXPECT_EQ(trace.front().task, top);
+
+		std::vector<int> traced(graph.size(), 0);
+		std::vector<TaskTrace> by_task(graph.size());
+		for (const TaskTrace& record : trace)
+		{
+			++traced[record.task];
+			by_task[record.task] = record;
+			EXPECT_STREQ(record.name, "test task");
+			EXPECT_LT(record.worker, pool.concurrency());
+			EXPECT_LE(record.begin, record.end);
+		}
+
+		EXPECT_THAT(traced, ::testing::Each(1));
+		EXPECT_LE(by_task[left].end, by_task[bottom].begin);
+		EXPECT_LE(by_task[right].end, by_task[bottom].begin);
+		EXPECT_LE(by_task[bottom].end, by_task.back().begin);
+
+		EXPECT_THROW(graph.depend(top, bottom), Matrix_InvalidDependency);
+		EXPECT_THROW(graph.depend(graph.size(), top), Matrix_InvalidDependency);
+	}
+
+	{
+		ThreadPool pool{ 2 };
+
+		std::atomic<int> after_failure{ 0 };
+		TaskGraph graph;
+		const TaskGraph::task_id failing = graph.add([] { throw Matrix_Exception{ "task failed" }; });
+		for (int i = 0; i < 8; ++i)
+		{
+			graph.depend(graph.add([&] { ++after_failure; }), failing);
+		}
+
+		try
+		{
+			graph.run(pool);
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_Exception& e)
+		{
+			EXPECT_STREQ(e.what(), "task failed");
+		}
+
+		EXPECT_EQ(after_failure, 0);
+
+		// Run from inside a pool task the graph executes on the calling thread
+		std::atomic<int> nested_hits{ 0 };
+		TaskGraph nested;
+		for (int i = 0; i < 6; ++i)
+		{
+			const TaskGraph::task_id id = nested.add([&] { ++nested_hits; });
+			if (i > 0)
+			{
+				nested.depend(id, id - 1);
+			}
+		}
+
+		pool.run(4, [&](size_t) { nested.run(pool); });
+		EXPECT_EQ(nested_hits, 24);
+	}
+
+	{
+		ThreadPool pool{ 3 };
+
+		// A long chain leaves the other workers without anything to steal until it fans out at the end
+		std::vector<int> order;
+		std::atomic<int> fanned_out{ 0 };
+		TaskGraph graph;
+		for (int i = 0; i < 40; ++i)
+		{
+			const TaskGraph::task_id id = graph.add([&order, i]
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+				order.push_back(i);
+			});
+
+			if (i > 0)
+			{
+				graph.depend(id, id - 1);
+			}
+		}
+
+		const TaskGraph::task_id chain_end = graph.size() - 1;
+		for (int i = 0; i < 12; ++i)
+		{
+			graph.depend(graph.add([&] { ++fanned_out; }), chain_end);
+		}
+
+		graph.run(pool);
+
+		std::vector<int> expected(40);
+		std::iota(expected.begin(), expected.end(), 0);
+		EXPECT_EQ(order, expected);
+		EXPECT_EQ(fanned_out, 12);
+	}
+}
+
+TEST(DMatrix_TaskGraphTests, T_002_TiledGemm)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = double;
+		using size_type = DMatrix<test_type>::size_type;
+
+		ThreadPool::instance().resize(3);
+
+		// Few output tiles and a long depth, so the tiles are split into chained depth panels
+		DMatrix<test_type> m1{ 150, 1200 };
+		DMatrix<test_type> m2{ 1200, 140 };
+		DMatrix<test_type> accumulator{ 150, 140 };
+		for (size_type i = 0; i < m1.size(); ++i)
+		{
+			m1[i] = static_cast<test_type>(i % 9) - 4;
+		}
+
+		for (size_type i = 0; i < m2.size(); ++i)
+		{
+			m2[i] = static_cast<test_type>(i % 5) - 2;
+		}
+
+		for (size_type i = 0; i < accumulator.size(); ++i)
+		{
+			accumulator[i] = static_cast<test_type>(i % 3);
+		}
+
+		DMatrix<test_type> expected{ accumulator.rows(), accumulator.columns() };
+		detail::gemm_naive(
+			m1.rows(), m2.columns(), m1.columns(),
+			m1.data(), m1.columns(), size_type{ 1 },
+			m2.data(), m2.columns(), size_type{ 1 },
+			expected.data(), expected.columns(), size_type{ 1 });
+
+		for (size_type i = 0; i < expected.size(); ++i)
+		{
+			expected[i] = std::max(expected[i] * 0.5 + accumulator[i] * 2.0, 0.0);
+		}
+
+		gemm(0.5, m1, m2, 2.0, accumulator, ReluEpilogue{});
+		EXPECT_TRUE(accumulator == expected);
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+TEST(DMatrix_NumaTests, T_001_Topology)
+{
+	using namespace PrimMatrix;
+
+	{
+		const NumaTopology& topology = NumaTopology::system();
+		ASSERT_GE(topology.node_count(), size_t{ 1 });
+
+		for (size_t node = 0; node < topology.node_count(); ++node)
+		{
+			EXPECT_FALSE(topology.cpus(node).empty());
+		}
+
+		// Threads are grouped by node in order, every node gets some once there are enough threads
+		const size_t thread_count = topology.node_count() * 3;
+		size_t previous_node = 0;
+		for (size_t thread = 0; thread < thread_count; ++thread)
+		{
+			const size_t node = topology.node_of_thread(thread, thread_count);
+			EXPECT_LT(node, topology.node_count());
+			EXPECT_GE(node, previous_node);
+			previous_node = node;
+		}
+
+		EXPECT_EQ(topology.node_of_thread(0, thread_count), size_t{ 0 });
+		EXPECT_EQ(previous_node, topology.node_count() - 1);
+	}
+}
+
+TEST(DMatrix_NumaTests, T_002_Placement)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = double;
+		using size_type = DMatrix<test_type>::size_type;
+
+		const ENumaPolicy default_policy = numa_policy();
+		ThreadPool::instance().resize(3);
+
+		for (const ENumaPolicy policy : { ENumaPolicy::local, ENumaPolicy::first_touch, ENumaPolicy::interleave })
+		{
+			set_numa_policy(policy);
+			EXPECT_EQ(numa_policy(), policy);
+
+			// Large enough to be initialized by the pool
+			const DMatrix<test_type> zeros{ 701, 503 };
+			EXPECT_TRUE(std::all_of(zeros.begin(), zeros.end(), [](const test_type value) { return value == 0.0; }));
+
+			const DMatrix<test_type> filled{ 701, 503, 2.5 };
+			EXPECT_TRUE(std::all_of(filled.begin(), filled.end(), [](const test_type value) { return value == 2.5; }));
+
+			const DMatrix<test_type, AlignedAllocator<test_type>> padded{ 701, 503, Padding{} };
+			EXPECT_TRUE(std::all_of(padded.data(), padded.data() + padded.rows() * padded.leading_dimension(), [](const test_type value) { return value == 0.0; }));
+
+			DMatrix<test_type> result{ 701, 503, uninitialized };
+			for (size_type i = 0; i < result.size(); ++i)
+			{
+				result[i] = static_cast<test_type>(i % 13);
+			}
+
+			const DMatrix<test_type> sum = add(execution::par, result, filled);
+			for (size_type i = 0; i < sum.size(); ++i)
+			{
+				ASSERT_EQ(sum[i], static_cast<test_type>(i % 13) + 2.5);
+			}
+
+			// Non-trivial elements are constructed as before
+			const DMatrix<std::complex<test_type>> complex_zeros{ 701, 503 };
+			EXPECT_TRUE(std::all_of(complex_zeros.begin(), complex_zeros.end(), [](const std::complex<test_type>& value) { return value == std::complex<test_type>{}; }));
+		}
+
+		set_numa_policy(default_policy);
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+		EXPECT_EQ(ThreadPool::instance().node_bound(), NumaTopology::system().node_count() > 1 && default_policy != ENumaPolicy::local);
+	}
+}
+
+TEST(DMatrix_AllocatorTests, T_001_AlignedAllocator)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = double;
+		using matrix_type = DMatrix<test_type, AlignedAllocator<test_type>>;
+
+		const matrix_type a{ 3, 5, 1.5 };
+		const matrix_type b{ 5, 2, 2.0 };
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a.data()) % cache_line_size, 0);
+
+		const matrix_type sum = a + a * 2.0;
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(sum.data()) % cache_line_size, 0);
+		EXPECT_THAT(sum, ::testing::Each(4.5));
+
+		const matrix_type product = a * b;
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(product.data()) % cache_line_size, 0);
+		EXPECT_THAT(product, ::testing::Each(15.0));
+
+		const auto transposed = a.transpose();
+		EXPECT_TRUE((std::is_same<decltype(transposed), const matrix_type>::value));
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(transposed.data()) % cache_line_size, 0);
+
+		// Mixed allocators compare and multiply, the result takes the left operand's allocator
+		const DMatrix<test_type> plain{ 3, 5, 1.5 };
+		EXPECT_TRUE(plain == a);
+		const auto mixed_product = plain * b;
+		EXPECT_TRUE((std::is_same<decltype(mixed_product), const DMatrix<test_type>>::value));
+		EXPECT_TRUE(mixed_product == product);
+	}
+
+	{
+		using test_type = float;
+
+		DMatrix<test_type, AlignedAllocator<test_type, 256>> matrix{ 7, 9 };
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(matrix.data()) % 256, 0);
+
+		matrix *= DMatrix<test_type, AlignedAllocator<test_type, 256>>::create_identity_matrix(9);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(matrix.data()) % 256, 0);
+	}
+}
+
+TEST(DMatrix_AllocatorTests, T_002_HugePageAllocator)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = double;
+		using matrix_type = DMatrix<test_type, HugePageAllocator<test_type>>;
+
+		const matrix_type small{ 4, 4, 1.0 };
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(small.data()) % cache_line_size, 0);
+
+		// 4 MiB, backed by huge pages where the system allows it
+		matrix_type large{ 512, 1024, 2.0 };
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large.data()) % huge_page_size, 0);
+
+		large += large;
+		EXPECT_THAT(large, ::testing::Each(4.0));
+	}
+}
+
+TEST(DMatrix_AllocatorTests, T_003_ArenaAllocator)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = double;
+
+		MatrixArena arena{ 64 * 1024 };
+		EXPECT_EQ(arena.used(), 0);
+
+		{
+			ArenaScope scope{ arena };
+
+			// Existing constructors pick up the scope's arena
+			const ArenaDMatrix<test_type> a{ 3, 4, 2.0 };
+			EXPECT_EQ(a.get_allocator().arena(), &arena);
+			EXPECT_GE(arena.used(), a.size() * sizeof(test_type));
+
+			const auto spliced = a.splice({ 1, 1, 2, 2 });
+			const auto transposed = a.transpose();
+			const ArenaDMatrix<test_type> product = a * transposed;
+			const ArenaDMatrix<test_type> sum = a + a * 2.0;
+			EXPECT_EQ(spliced.get_allocator().arena(), &arena);
+			EXPECT_EQ(transposed.get_allocator().arena(), &arena);
+			EXPECT_EQ(product.get_allocator().arena(), &arena);
+			EXPECT_EQ(sum.get_allocator().arena(), &arena);
+
+			EXPECT_THAT(spliced, ::testing::Each(2.0));
+			EXPECT_THAT(product, ::testing::Each(16.0));
+			EXPECT_THAT(sum, ::testing::Each(6.0));
+
+			{
+				// Nested scopes give back only their own allocations
+				const auto used = arena.used();
+				{
+					ArenaScope nested_scope{ arena };
+					const ArenaDMatrix<test_type> temporary{ 100, 100 };
+					EXPECT_GT(arena.used(), used);
+				}
+				EXPECT_EQ(arena.used(), used);
+			}
+
+			// Larger than a block, gets a dedicated one
+			const ArenaDMatrix<test_type> large{ 200, 100, 1.0 };
+			EXPECT_GE(arena.capacity(), 2 * 64 * 1024);
+			EXPECT_THAT(large, ::testing::Each(1.0));
+		}
+
+		EXPECT_EQ(arena.used(), 0);
+		EXPECT_EQ(MatrixArena::current(), nullptr);
+
+		arena.release();
+		EXPECT_EQ(arena.capacity(), 0);
+	}
+
+	{
+		using test_type = int;
+
+		// Without a scope the allocator falls back to the heap
+		ArenaDMatrix<test_type> a{ 2, 2, {1,2,3,4} };
+		EXPECT_EQ(a.get_allocator().arena(), nullptr);
+
+		a *= a;
+		EXPECT_THAT(a, ::testing::ElementsAre(7, 10, 15, 22));
+
+		MatrixArena arena;
+		const ArenaDMatrix<test_type> explicit_arena{ 2, 2, 1, ArenaAllocator<test_type>{ arena } };
+		EXPECT_EQ(explicit_arena.get_allocator().arena(), &arena);
+
+		// Assignment keeps the destination's heap allocator, so it survives the arena
+		a = explicit_arena;
+		EXPECT_EQ(a.get_allocator().arena(), nullptr);
+
+		ArenaDMatrix<test_type> moved_from{ 2, 2, 2, ArenaAllocator<test_type>{ arena } };
+		ArenaDMatrix<test_type> b{ 1, 1 };
+		b = std::move(moved_from);
+		EXPECT_EQ(b.get_allocator().arena(), nullptr);
+
+		arena.reset();
+		const ArenaDMatrix<test_type> reusing_arena{ 4, 4, 9, ArenaAllocator<test_type>{ arena } };
+		EXPECT_THAT(a, ::testing::ElementsAre(1, 1, 1, 1));
+		EXPECT_THAT(b, ::testing::ElementsAre(2, 2, 2, 2));
+	}
+}
+
+template <class T>
+std::vector<T> kernel_test_values(const size_t size, const int modulo)
+{
+	// Small integers keep float sums exact, so kernels can be compared for equality
+	std::vector<T> values(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		values[i] = static_cast<T>(static_cast<int>(i * 7 % modulo) - modulo / 2);
+	}
+
+	return values;
+}
+
+template <class T>
+void check_gemm_kernels()
+{
+	using namespace PrimMatrix::detail;
+
+	const size_t m = 67, n = 53, k = 301;
+	const auto a = kernel_test_values<T>(m * k, 17);
+	const auto b = kernel_test_values<T>(k * n, 13);
+
+	std::vector<T> expected(m * n);
+	gemm_naive(m, n, k, a.data(), k, size_t{ 1 }, b.data(), n, size_t{ 1 }, expected.data(), n, size_t{ 1 });
+
+	for (const auto level : { ESimdLevel::scalar, ESimdLevel::avx2, ESimdLevel::avx512 })
+	{
+		if (static_cast<int>(level) > static_cast<int>(simd_level()))
+		{
+			continue;
+		}
+
+		std::vector<T> result(m * n);
+		gemm_blocked(gemm_kernel<T>(level), m, n, k, a.data(), k, size_t{ 1 }, b.data(), n, size_t{ 1 }, result.data(), n, size_t{ 1 });
+		EXPECT_EQ(result, expected);
+
+		// Transposed operands through the strides
+		std::vector<T> transposed_result(m * n);
+		gemm_blocked(gemm_kernel<T>(level), n, m, k, b.data(), size_t{ 1 }, n, a.data(), size_t{ 1 }, k, transposed_result.data(), size_t{ 1 }, n);
+		EXPECT_EQ(transposed_result, expected);
+	}
+}
+
+template <class T>
+void check_elementwise_kernels()
+{
+	using namespace PrimMatrix::detail;
+
+	const size_t n = 1031;
+	const auto lhs = kernel_test_values<T>(n, 17);
+	const auto rhs = kernel_test_values<T>(n, 13);
+	const T scalar = 3;
+
+	std::vector<T> expected_add(n), expected_subtract(n), expected_scale(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		expected_add[i] = lhs[i] + rhs[i];
+		expected_subtract[i] = lhs[i] - rhs[i];
+		expected_scale[i] = lhs[i] * scalar;
+	}
+
+	for (const auto level : { ESimdLevel::scalar, ESimdLevel::avx2, ESimdLevel::avx512 })
+	{
+		if (static_cast<int>(level) > static_cast<int>(simd_level()))
+		{
+			continue;
+		}
+
+		const auto kernels = elementwise_kernels<T>(level);
+		std::vector<T> result(n);
+
+		kernels.add(n, lhs.data(), rhs.data(), T{}, result.data());
+		EXPECT_EQ(result, expected_add);
+
+		kernels.subtract(n, lhs.data(), rhs.data(), T{}, result.data());
+		EXPECT_EQ(result, expected_subtract);
+
+		kernels.scale(n, lhs.data(), nullptr, scalar, result.data());
+		EXPECT_EQ(result, expected_scale);
+
+		// In place, as used by the compound assignment operators
+		result = lhs;
+		kernels.add(n, result.data(), rhs.data(), T{}, result.data());
+		EXPECT_EQ(result, expected_add);
+	}
+}
+
+template <class T>
+void check_gemv_kernels()
+{
+	using namespace PrimMatrix::detail;
+
+	const size_t n = 1031;
+	const auto lhs = kernel_test_values<T>(n, 17);
+	const auto rhs = kernel_test_values<T>(n, 13);
+	const T scalar = 3;
+
+	for (const size_t length : { size_t{ 0 }, size_t{ 5 }, size_t{ 70 }, n })
+	{
+		const T expected_dot = dot_generic(length, lhs.data(), rhs.data());
+
+		std::vector<T> expected_axpy = rhs;
+		axpy_generic(length, scalar, lhs.data(), expected_axpy.data());
+
+		for (const auto level : { ESimdLevel::scalar, ESimdLevel::avx2, ESimdLevel::avx512 })
+		{
+			if (static_cast<int>(level) > static_cast<int>(simd_level()))
+			{
+				continue;
+			}
+
+			const auto kernels = gemv_kernels<T>(level);
+			EXPECT_EQ(kernels.dot(length, lhs.data(), rhs.data()), expected_dot);
+
+			std::vector<T> result = rhs;
+			kernels.axpy(length, scalar, lhs.data(), result.data());
+			EXPECT_EQ(result, expected_axpy);
+		}
+	}
+}
+
+template <class T>
+void check_transpose_kernels()
+{
+	using namespace PrimMatrix::detail;
+
+	const size_t rows = 37, columns = 29, src_ld = 31, dst_ld = 41;
+	std::vector<T> src(rows * src_ld);
+	std::iota(src.begin(), src.end(), T{});
+
+	std::vector<T> expected(columns * dst_ld);
+	for (size_t row = 0; row < rows; ++row)
+	{
+		for (size_t column = 0; column < columns; ++column)
+		{
+			expected[column * dst_ld + row] = src[row * src_ld + column];
+		}
+	}
+
+	for (const auto level : { ESimdLevel::scalar, ESimdLevel::avx2, ESimdLevel::avx512 })
+	{
+		if (static_cast<int>(level) > static_cast<int>(simd_level()))
+		{
+			continue;
+		}
+
+		std::vector<T> result(columns * dst_ld);
+		transpose_tile(transpose_kernel<T>(level), rows, columns, src.data(), src_ld, result.data(), dst_ld);
+		EXPECT_EQ(result, expected);
+	}
+
+	// Several tiles, split over the pool
+	{
+		using PrimMatrix::ThreadPool;
+
+		const size_t large_rows = 700, large_columns = 650;
+		std::vector<T> large(large_rows * large_columns);
+		std::iota(large.begin(), large.end(), T{});
+
+		ThreadPool::instance().resize(3);
+
+		std::vector<T> result(large_rows * large_columns);
+		transpose(large_rows, large_columns, large.data(), large_columns, result.data(), large_rows);
+
+		bool matches = true;
+		for (size_t row = 0; row < large_rows; ++row)
+		{
+			for (size_t column = 0; column < large_columns; ++column)
+			{
+				matches = matches && result[column * large_rows + row] == large[row * large_columns + column];
+			}
+		}
+		EXPECT_TRUE(matches);
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+TEST(DMatrix_KernelTests, T_001_GemmKernels)
+{
+	check_gemm_kernels<float>();
+	check_gemm_kernels<double>();
+	check_gemm_kernels<int>();
+}
+
+TEST(DMatrix_KernelTests, T_002_ElementwiseKernels)
+{
+	check_elementwise_kernels<float>();
+	check_elementwise_kernels<double>();
+	check_elementwise_kernels<int>();
+}
+
+TEST(DMatrix_KernelTests, T_003_TransposeKernels)
+{
+	check_transpose_kernels<float>();
+	check_transpose_kernels<double>();
+	check_transpose_kernels<int>();
+}
+
+TEST(DMatrix_KernelTests, T_004_GemvKernels)
+{
+	check_gemv_kernels<float>();
+	check_gemv_kernels<double>();
+	check_gemv_kernels<int>();
+}
+
+TEST(DMatrix_Operations, T_001_Transpose)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		const test_data<test_type> test_data{ 5, 2 };
+
+		const std::vector<test_type> vec{ 1,2,3,4,5,6,7,8,9,10 };
+
+		const DMatrix<test_type> matrix(test_data.rows, test_data.columns, vec);
+		const DMatrix<test_type> transposed = matrix.transpose();
+
+		EXPECT_EQ(transposed.rows(), test_data.columns);
+		EXPECT_EQ(transposed.columns(), test_data.rows);
+		EXPECT_EQ(transposed.size(), test_data.size);
+
+		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 3, 5, 7, 9, 2, 4, 6, 8, 10));
+	}
+
+	{
+		using test_type = int;
+		const test_data<test_type> test_data{ 2, 5 };
+
+		const std::vector<test_type> vec{ 1,2,3,4,5,6,7,8,9,10 };
+
+		const DMatrix<test_type> matrix(test_data.rows, test_data.columns, vec);
+		const DMatrix<test_type> transposed = matrix.transpose();
+
+		EXPECT_EQ(transposed.rows(), test_data.columns);
+		EXPECT_EQ(transposed.columns(), test_data.rows);
+		EXPECT_EQ(transposed.size(), test_data.size);
+
+		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 6, 2, 7, 3, 8, 4, 9, 5, 10));
+	}
+}
+
+TEST(DMatrix_Operations, T_004_TransposeInPlace)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+
+		DMatrix<test_type> rectangular{ 2, 3, {1, 2, 3, 4, 5, 6} };
+		const test_type* const storage = rectangular.data();
+		rectangular.transpose_in_place();
+
+		EXPECT_EQ(rectangular.rows(), 3);
+		EXPECT_EQ(rectangular.columns(), 2);
+		EXPECT_EQ(rectangular.data(), storage);
+		EXPECT_THAT(rectangular, ::testing::ElementsAre(1, 4, 2, 5, 3, 6));
+
+		DMatrix<test_type, std::allocator<test_type>, ColumnMajor> column_major{ 2, 3, {1, 4, 2, 5, 3, 6} };
+		column_major.transpose_in_place();
+		EXPECT_TRUE(column_major == rectangular);
+	}
+
+	{
+		using test_type = double;
+
+		for (const auto& shape : { std::make_pair(size_t{ 101 }, size_t{ 101 }), std::make_pair(size_t{ 37 }, size_t{ 29 }), std::make_pair(size_t{ 1 }, size_t{ 9 }) })
+		{
+			DMatrix<test_type> matrix{ shape.first, shape.second };
+			DMatrix<test_type> padded{ shape.first, shape.second, Padding{} };
+			for (size_t i = 0; i < matrix.size(); ++i)
+			{
+				matrix[i] = padded[i] = static_cast<test_type>(i);
+			}
+
+			const DMatrix<test_type> expected = matrix.transpose();
+
+			matrix.transpose_in_place();
+			EXPECT_TRUE(matrix == expected);
+			EXPECT_FALSE(matrix.padded());
+
+			padded.transpose_in_place();
+			EXPECT_TRUE(padded == expected);
+			EXPECT_EQ(padded.rows(), expected.rows());
+		}
+	}
+}
+
+TEST(DMatrix_Operations, T_002_CreateIdentityMatrix)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		const DMatrix<test_type>::value_type size = 3;
+		const auto identity_matrix = DMatrix<test_type>::create_identity_matrix(size);
+
+		EXPECT_EQ(identity_matrix.rows(), size);
+		EXPECT_EQ(identity_matrix.columns(), size);
+		EXPECT_EQ(identity_matrix.size(), size * size);
+
+		EXPECT_THAT(identity_matrix, ::testing::ElementsAre(1, 0, 0, 0, 1, 0, 0, 0, 1));
+	}
+
+
+	{
+		using test_type = int;
+		const DMatrix<test_type>::value_type size = 1;
+		const auto identity_matrix = DMatrix<test_type>::create_identity_matrix(size);
+
+		EXPECT_EQ(identity_matrix.rows(), size);
+		EXPECT_EQ(identity_matrix.columns(), size);
+		EXPECT_EQ(identity_matrix.size(), size * size);
+
+		EXPECT_THAT(identity_matrix, ::testing::ElementsAre(1));
+	}
+}
+
+TEST(DMatrix_Operations, T_003_Splice)
+{
+	using namespace PrimMatrix;
+
+	{
+		using test_type = int;
+		const DMatrix<test_type> matrix{ 3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12} };
+		
+		const auto spliced = matrix.splice({ 1, 2, 2, 2 });
+
+		EXPECT_THAT(spliced, ::testing::ElementsAre(7, 8, 11, 12));
+
+		const Splice splice_row_out_of_bounds{ 1, 2, 3, 2 };
+		const Splice splice_column_out_of_bounds{ 1, 2, 2, 3 };
+		try
+		{
+			matrix.splice(splice_row_out_of_bounds);
+
+			EXPECT_TRUE(false);
+		}
+		catch(const Matrix_SpliceOutOfBounds& e)
+		{
+			EXPECT_EQ(e.splice(), splice_row_out_of_bounds);
+			EXPECT_EQ(e.matrix_rows(), matrix.rows());
+			EXPECT_EQ(e.matrix_columns(), matrix.columns());
+		}
+
+		try
+		{
+			matrix.splice(splice_column_out_of_bounds);
+
+			EXPECT_TRUE(false);
+		}
+		catch (const Matrix_SpliceOutOfBounds& e)
+		{
+			EXPECT_EQ(e.splice(), splice_column_out_of_bounds);
+			EXPECT_EQ(e.matrix_rows(), matrix.rows());
+			EXPECT_EQ(e.matrix_columns(), matrix.columns());
+		}
+	}
+}
+TEST(DMatrix_InteropTests, T_001_SMatrixViews)
+{
+	using namespace PrimMatrix;
+
+	// SMatrix storage read and written as a dynamic view
+	{
+		SMatrix<int, 2, 3> matrix{ 1, 2, 3, 4, 5, 6 };
+		const MatrixView<int> matrix_view = view(matrix);
+		EXPECT_EQ(matrix_view.data(), matrix.data());
+		EXPECT_EQ(matrix_view.rows(), 2u);
+		EXPECT_EQ(matrix_view.columns(), 3u);
+
+		matrix_view(1, 2) = 60;
+		EXPECT_EQ(matrix(1, 2), 60);
+
+		const SMatrix<int, 2, 3, ColumnMajor> column_major{ 1, 4, 2, 5, 3, 6 };
+		const DMatrix<int> copied{ view(column_major) };
+		EXPECT_THAT(copied, ::testing::ElementsAre(1, 2, 3, 4, 5, 6));
+	}
+
+	// Fixed-size blocks of a DMatrix
+	{
+		DMatrix<int> matrix{ 3, 4, { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 } };
+		const SMatrixRef<int, 2, 2> corner = block<2, 2>(matrix, 1, 2);
+		EXPECT_EQ(corner(0, 0), 7);
+		EXPECT_EQ(corner(1, 1), 12);
+		EXPECT_EQ(&corner(1, 0), &matrix(2, 2));
+
+		const SMatrix<int, 2, 2> copied = corner;
+		EXPECT_THAT(copied, ::testing::ElementsAre(7, 8, 11, 12));
+
+		block<2, 2>(matrix, 0, 0) = SMatrix<int, 2, 2, ColumnMajor>{ -1, -3, -2, -4 };
+		block<1, 4>(matrix, 2, 0) *= 10;
+		EXPECT_THAT(matrix, ::testing::ElementsAre(-1, -2, 3, 4, -3, -4, 7, 8, 90, 100, 110, 120));
+
+		block<2, 2>(matrix, 0, 2) = block<2, 2>(matrix, 1, 0);
+		EXPECT_THAT(matrix.splice({ 0, 2, 2, 2 }), ::testing::ElementsAre(-3, -4, 90, 100));
+
+		const DMatrix<int>& const_matrix = matrix;
+		const SMatrixRef<const int, 3, 1> column = block<3, 1>(const_matrix, 0, 3);
+		EXPECT_THAT(column.matrix(), ::testing::ElementsAre(-4, 100, 120));
+		EXPECT_THROW((block<2, 2>(const_matrix, 2, 0)), Matrix_SpliceOutOfBounds);
+		EXPECT_THROW(column.at(0, 1), Matrix_RowColOutOfBounds);
+
+		// Blocks of padded and column-major storage keep their leading dimension
+		DMatrix<double, std::allocator<double>, ColumnMajor> padded{ 5, 5, Padding{ 8 } };
+		block<2, 2>(padded, 3, 3) = SMatrix<double, 2, 2>{ 1, 2, 3, 4 };
+		const SMatrixRef<double, 2, 2, ColumnMajor> padded_block = block<2, 2>(padded, 3, 3);
+		EXPECT_EQ(padded(4, 3), 3);
+		EXPECT_EQ(padded_block.leading_dimension(), 8u);
+		EXPECT_EQ(padded_block.view()(0, 1), 2);
+	}
+}
+
+TEST(DMatrix_InteropTests, T_002_MixedArithmetic)
+{
+	using namespace PrimMatrix;
+
+	// Fixed-size results where both sizes are known
+	{
+		DMatrix<int> matrix{ 3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 } };
+		const SMatrix<int, 2, 2> fixed{ 1, 0, 0, 2 };
+		const SMatrixRef<int, 2, 2> top_left = block<2, 2>(matrix, 0, 0);
+
+		const SMatrix<int, 2, 2> sum = top_left + fixed;
+		const SMatrix<int, 2, 2> difference = fixed - top_left;
+		const SMatrix<int, 2, 2> product = fixed * top_left;
+		const SMatrix<int, 2, 2> ref_product = top_left * block<2, 2>(matrix, 1, 1);
+		const SMatrix<int, 2, 2> scaled = top_left * 3;
+		EXPECT_THAT(sum, ::testing::ElementsAre(2, 2, 4, 7));
+		EXPECT_THAT(difference, ::testing::ElementsAre(0, -2, -4, -3));
+		EXPECT_THAT(product, ::testing::ElementsAre(1, 2, 8, 10));
+		EXPECT_THAT(ref_product, ::testing::ElementsAre(21, 24, 60, 69));
+		EXPECT_THAT(scaled, ::testing::ElementsAre(3, 6, 12, 15));
+
+		const DMatrix<int> dynamic{ 2, 2, { 10, 20, 30, 40 } };
+		const SMatrix<int, 2, 2> dynamic_sum = fixed + dynamic;
+		const SMatrix<int, 2, 2> dynamic_difference = dynamic - fixed;
+		EXPECT_THAT(dynamic_sum, ::testing::ElementsAre(11, 20, 30, 42));
+		EXPECT_THAT(dynamic_difference, ::testing::ElementsAre(9, 20, 30, 38));
+		EXPECT_THROW(fixed + matrix, Matrix_OperationMatrixMismatch);
+	}
+
+	// A fixed transform applied to a dynamic point cloud
+	{
+		const size_t count = 1000;
+		DMatrix<double> points{ count, 3 };
+		for (size_t i = 0; i < count; ++i)
+		{
+			points(i, 0) = static_cast<double>(i);
+			points(i, 1) = static_cast<double>(i % 7);
+			points(i, 2) = -static_cast<double>(i % 3);
+		}
+
+		const SMatrix<double, 3, 3, ColumnMajor> rotation{ 0, 1, 0, -1, 0, 0, 0, 0, 1 };
+		const DMatrix<double> rotated = points * rotation.transpose();
+		const DMatrix<double, std::allocator<double>, ColumnMajor> rotated_columns = rotation * points.t();
+		ASSERT_EQ(rotated.rows(), count);
+		ASSERT_EQ(rotated.columns(), 3u);
+		ASSERT_EQ(rotated_columns.rows(), 3u);
+
+		bool matches = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			matches = matches && rotated(i, 0) == -points(i, 1) && rotated(i, 1) == points(i, 0) && rotated(i, 2) == points(i, 2);
+			matches = matches && rotated_columns(0, i) == rotated(i, 0) && rotated_columns(2, i) == rotated(i, 2);
+		}
+		EXPECT_TRUE(matches);
+
+		DMatrix<double> translated{ count, 3, 1.0 };
+		gemm(1.0, points, view(rotation.transpose()), 1.0, translated);
+		EXPECT_EQ(translated(10, 0), rotated(10, 0) + 1.0);
+		EXPECT_THROW(rotation * points, Matrix_OperationMatrixMismatch);
+	}
+}
+
+template <class Fixed, class Dynamic>
+void check_fixed_products(const Fixed& fixed, const Dynamic& lhs, const Dynamic& rhs)
+{
+	using namespace PrimMatrix;
+
+	// view() keeps the fixed side on GEMM, which the row-by-row products have to agree with
+	const auto rhs_product = lhs * fixed;
+	const auto lhs_product = fixed * rhs;
+	EXPECT_TRUE(rhs_product == lhs * view(fixed));
+	EXPECT_TRUE(lhs_product == view(fixed) * rhs);
+}
+
+TEST(DMatrix_InteropTests, T_003_SmallFixedProducts)
+{
+	using namespace PrimMatrix;
+
+	const auto fill = [](auto& matrix)
+	{
+		for (size_t row = 0; row < matrix.rows(); ++row)
+		{
+			for (size_t column = 0; column < matrix.columns(); ++column)
+			{
+				matrix(row, column) = static_cast<typename std::decay<decltype(matrix)>::type::value_type>(static_cast<int>((row * 7 + column * 3) % 11) - 5);
+			}
+		}
+	};
+
+	// Transforms of point clouds walk the rows, a 9x9 side already goes through GEMM
+	{
+		SMatrix<double, 3, 3> rotation{};
+		SMatrix<float, 4, 4, ColumnMajor> transform{};
+		SMatrix<double, 9, 9> large{};
+		const SMatrix<double, 4, 4> mismatched{};
+		const SMatrix<double, 3, 3, ColumnMajor> column_rotation{};
+		fill(rotation);
+		fill(transform);
+		fill(large);
+
+		DMatrix<double> points{ 1000, 3 };
+		DMatrix<double> columns{ 3, 1000 };
+		DMatrix<float, std::allocator<float>, ColumnMajor> homogeneous{ 1000, 4 };
+		DMatrix<float, std::allocator<float>, ColumnMajor> homogeneous_columns{ 4, 1000 };
+		DMatrix<double> wide{ 1000, 9 };
+		DMatrix<double> tall{ 9, 1000 };
+		fill(points);
+		fill(columns);
+		fill(homogeneous);
+		fill(homogeneous_columns);
+		fill(wide);
+		fill(tall);
+
+		check_fixed_products(rotation, points, columns);
+		check_fixed_products(transform, homogeneous, homogeneous_columns);
+		check_fixed_products(large, wide, tall);
+
+		// Expressions are evaluated first, transposed views are read in place
+		const DMatrix<double> scaled = (points * 2.0) * rotation;
+		EXPECT_TRUE(scaled == (points * 2.0) * view(rotation));
+		EXPECT_TRUE(points.t() * points * rotation == points.t() * points * view(rotation));
+		EXPECT_TRUE(columns.t() * rotation == columns.t() * view(rotation));
+		EXPECT_THROW(points * mismatched, Matrix_OperationMatrixMismatch);
+		EXPECT_THROW(rotation * points, Matrix_OperationMatrixMismatch);
+
+		// The storage order both operands share, row-major otherwise
+		EXPECT_TRUE((std::is_same<decltype(points * rotation), DMatrix<double>>::value));
+		EXPECT_TRUE((std::is_same<decltype(homogeneous * transform), DMatrix<float, std::allocator<float>, ColumnMajor>>::value));
+		EXPECT_TRUE((std::is_same<decltype(points * column_rotation), DMatrix<double>>::value));
+	}
+
+	// Split over the pool
+	{
+		ThreadPool::instance().resize(3);
+
+		SMatrix<double, 4, 4> transform{};
+		DMatrix<double> points{ 50000, 4 };
+		DMatrix<double> columns{ 4, 50000 };
+		fill(transform);
+		fill(points);
+		fill(columns);
+		check_fixed_products(transform, points, columns);
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+template <class Matrix>
+void check_elementwise_policies(Matrix lhs, Matrix rhs)
+{
+	using namespace PrimMatrix;
+	using value_type = typename Matrix::value_type;
+
+	for (size_t row = 0; row < lhs.rows(); ++row)
+	{
+		for (size_t column = 0; column < lhs.columns(); ++column)
+		{
+			lhs(row, column) = static_cast<value_type>((row * 7 + column * 3) % 13);
+			rhs(row, column) = static_cast<value_type>((row * 5 + column) % 11) - 5;
+		}
+	}
+
+	const Matrix sum = lhs + rhs;
+	const Matrix difference = lhs - rhs;
+	const Matrix scaled = lhs * value_type{ 3 };
+
+	EXPECT_TRUE(add(execution::seq, lhs, rhs) == sum);
+	EXPECT_TRUE(add(execution::par, lhs, rhs) == sum);
+	EXPECT_TRUE(subtract(execution::par_unseq, lhs, rhs) == difference);
+	EXPECT_TRUE(scale(execution::par, lhs, value_type{ 3 }) == scaled);
+	EXPECT_EQ(add(execution::par, lhs, rhs).leading_dimension(), lhs.leading_dimension());
+
+	Matrix in_place{ lhs };
+	in_place.add(execution::par, rhs);
+	EXPECT_TRUE(in_place == sum);
+	in_place.subtract(execution::par_unseq, rhs).subtract(execution::seq, rhs);
+	EXPECT_TRUE(in_place == difference);
+	in_place = lhs;
+	in_place.scale(execution::par, value_type{ 3 });
+	EXPECT_TRUE(in_place == scaled);
+}
+
+TEST(DMatrix_ExecutionTests, T_001_ElementwisePolicies)
+{
+	using namespace PrimMatrix;
+
+	static_assert(is_execution_policy<execution::parallel_policy>::value, "par is a policy");
+	static_assert(!is_execution_policy<int>::value, "int is not a policy");
+
+	ThreadPool::instance().resize(3);
+
+	// Below and above the serial cutoff, contiguous and line by line
+	check_elementwise_policies(DMatrix<int>{ 17, 23 }, DMatrix<int>{ 17, 23 });
+	check_elementwise_policies(DMatrix<double>{ 700, 530 }, DMatrix<double>{ 700, 530 });
+	check_elementwise_policies(DMatrix<float, std::allocator<float>, ColumnMajor>{ 1031, 300 }, DMatrix<float, std::allocator<float>, ColumnMajor>{ 1031, 300 });
+	check_elementwise_policies(DMatrix<double>{ 600, 517, Padding{} }, DMatrix<double>{ 600, 517, Padding{} });
+
+	{
+		const DMatrix<double> lhs{ 600, 600 };
+		DMatrix<double> rhs{ 600, 601 };
+		EXPECT_THROW(add(execution::par, lhs, rhs), Matrix_OperationMatrixMismatch);
+		EXPECT_THROW(rhs.subtract(execution::par, lhs), Matrix_OperationMatrixMismatch);
+	}
+
+	ThreadPool::instance().resize(ThreadPool::default_worker_count());
+}
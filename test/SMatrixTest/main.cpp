@@ -1,8 +1,11 @@
 #include "src/SMatrix.h"
+#include "src/SMatrixBatch.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
 #include <array>
+#include <cstdint>
+#include <vector>
 
 using namespace PrimMatrix;
 
@@ -337,4 +340,446 @@ TEST(OperationsTests, Splice)
 
 		EXPECT_THAT(spliced, ::testing::ElementsAre(7, 8, 11, 12));
 	}
-}
\ No newline at end of file
+}
+TEST(OperationsTests, StorageOrder)
+{
+	{
+		constexpr SMatrix<int, 2, 3, ColumnMajor> matrix{ 1, 4, 2, 5, 3, 6 };
+		constexpr SMatrix<int, 3, 2> rhs{ 1, 2, 3, 4, 5, 6 };
+
+		EXPECT_EQ(matrix(0, 1), 2);
+		EXPECT_EQ(matrix(1, 0), 4);
+		EXPECT_EQ(matrix.at(1, 2), 6);
+
+		constexpr SMatrix<int, 3, 2, ColumnMajor> transposed = matrix.transpose();
+		EXPECT_THAT(transposed, ::testing::ElementsAre(1, 2, 3, 4, 5, 6));
+
+		constexpr SMatrix<int, 2, 2, ColumnMajor> spliced = matrix.splice<0, 1, 2, 2>();
+		EXPECT_THAT(spliced, ::testing::ElementsAre(2, 5, 3, 6));
+
+		constexpr SMatrix<int, 2, 2, ColumnMajor> product = matrix * rhs;
+		EXPECT_THAT(product, ::testing::ElementsAre(22, 49, 28, 64));
+
+		constexpr SMatrix<int, 2, 3, ColumnMajor> sum = matrix + matrix;
+		EXPECT_THAT(sum, ::testing::ElementsAre(2, 8, 4, 10, 6, 12));
+	}
+}
+
+template <class T, size_t Rows, size_t Columns, class Order>
+std::vector<SMatrix<T, Rows, Columns, Order>> batch_test_matrices(const size_t count, const int seed)
+{
+	// Small integers keep float products exact, so the batch can be compared for equality
+	std::vector<SMatrix<T, Rows, Columns, Order>> matrices(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (size_t element = 0; element < Rows * Columns; ++element)
+		{
+			matrices[i][element] = static_cast<T>(static_cast<int>((i * 7 + element * 3 + seed) % 11) - 5);
+		}
+	}
+
+	return matrices;
+}
+
+template <class T, size_t Rows, size_t Common, size_t Columns, class LhsOrder, class RhsOrder>
+void check_batch_multiply(const size_t count)
+{
+	const auto lhs = batch_test_matrices<T, Rows, Common, LhsOrder>(count, 1);
+	const auto rhs = batch_test_matrices<T, Common, Columns, RhsOrder>(count, 4);
+
+	std::vector<SMatrix<T, Rows, Columns, LhsOrder>> result(count);
+	batch_multiply(lhs.data(), rhs.data(), result.data(), count);
+
+	bool matches = true;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const SMatrix<T, Rows, Columns, LhsOrder> expected = lhs[i] * rhs[i];
+		matches = matches && std::equal(expected.begin(), expected.end(), result[i].begin());
+	}
+	EXPECT_TRUE(matches);
+}
+
+TEST(OperationsTests, BatchMultiply)
+{
+	for (const size_t count : { size_t{ 0 }, size_t{ 3 }, size_t{ 37 }, size_t{ 1000 } })
+	{
+		check_batch_multiply<float, 4, 4, 4, RowMajor, RowMajor>(count);
+		check_batch_multiply<float, 4, 4, 4, ColumnMajor, ColumnMajor>(count);
+		check_batch_multiply<double, 3, 3, 3, RowMajor, RowMajor>(count);
+		check_batch_multiply<double, 2, 3, 4, ColumnMajor, RowMajor>(count);
+		check_batch_multiply<int, 3, 2, 3, RowMajor, ColumnMajor>(count);
+	}
+
+	// In place and split over the pool
+	{
+		ThreadPool::instance().resize(3);
+
+		const size_t count = 20000;
+		auto lhs = batch_test_matrices<float, 4, 4, RowMajor>(count, 2);
+		const auto rhs = batch_test_matrices<float, 4, 4, RowMajor>(count, 5);
+
+		std::vector<SMatrix<float, 4, 4>> expected(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			expected[i] = lhs[i] * rhs[i];
+		}
+
+		batch_multiply(lhs.data(), rhs.data(), lhs.data(), count);
+
+		bool matches = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			matches = matches && std::equal(expected[i].begin(), expected[i].end(), lhs[i].begin());
+		}
+		EXPECT_TRUE(matches);
+
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+TEST(OperationsTests, BatchMultiplyDense)
+{
+	using namespace PrimMatrix::detail;
+
+	// float 4x4 fills whole registers and is multiplied without interleaving wherever there are vector units
+	const batch_multiply_dense_kernel<float> float_kernel = selected_batch_multiply_dense_kernel<float, 4, 4, 4>();
+	const batch_multiply_dense_kernel<double> double_kernel = selected_batch_multiply_dense_kernel<double, 3, 3, 3>();
+	EXPECT_EQ(float_kernel != nullptr, simd_level() != ESimdLevel::scalar);
+	EXPECT_TRUE(double_kernel == nullptr);
+
+	const size_t count = 37;
+	const auto lhs = batch_test_matrices<float, 4, 4, RowMajor>(count, 3);
+	const auto rhs = batch_test_matrices<float, 4, 4, RowMajor>(count, 6);
+
+	for (const auto level : { ESimdLevel::avx2, ESimdLevel::avx512 })
+	{
+		const batch_multiply_dense_kernel<float> kernel = BatchMultiplyDenseKernels<float, 4, 4, 4>::select(level);
+		if (kernel == nullptr || static_cast<int>(level) > static_cast<int>(simd_level()))
+		{
+			continue;
+		}
+
+		std::vector<SMatrix<float, 4, 4>> result(count);
+		kernel(lhs[0].data(), rhs[0].data(), result[0].data(), count);
+
+		bool matches = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const SMatrix<float, 4, 4> expected = lhs[i] * rhs[i];
+			matches = matches && std::equal(expected.begin(), expected.end(), result[i].begin());
+		}
+		EXPECT_TRUE(matches);
+	}
+}
+
+template <class T, size_t Rows, size_t Common, size_t Columns, class Order>
+void check_soa_batch(const size_t count)
+{
+	const auto lhs = batch_test_matrices<T, Rows, Common, Order>(count, 1);
+	const auto other = batch_test_matrices<T, Rows, Common, Order>(count, 3);
+	const auto rhs = batch_test_matrices<T, Common, Columns, Order>(count, 4);
+	const auto lhs_other_order = batch_test_matrices<T, Rows, Common, typename Order::transposed>(count, 1);
+
+	const SMatrixBatch<T, Rows, Common, Order> lhs_batch{ lhs.data(), count };
+	const SMatrixBatch<T, Rows, Common, Order> other_batch{ other.data(), count };
+	const SMatrixBatch<T, Common, Columns, Order> rhs_batch{ rhs.data(), count };
+	const SMatrixBatch<T, Rows, Common, Order> converted_batch{ lhs_other_order.data(), count };
+
+	const SMatrix<T, Common, Rows, Order> transform = batch_test_matrices<T, Common, Rows, Order>(1, 7).front();
+	const auto sum = lhs_batch + other_batch;
+	const auto difference = lhs_batch - other_batch;
+	const auto scaled = lhs_batch * T{ 3 };
+	const auto product = lhs_batch * rhs_batch;
+	const auto transposed = lhs_batch.transpose();
+	const auto transformed = transform * lhs_batch;
+	const auto transformed_right = lhs_batch * transform;
+
+	bool matches = true;
+	const auto same = [](const auto& expected, const auto& actual)
+	{
+		return std::equal(expected.begin(), expected.end(), actual.begin());
+	};
+	for (size_t i = 0; i < count; ++i)
+	{
+		matches = matches && same(lhs[i] + other[i], sum[i].matrix());
+		matches = matches && same(lhs[i] - other[i], difference[i].matrix());
+		matches = matches && same(lhs[i] * T{ 3 }, scaled[i].matrix());
+		matches = matches && same(lhs[i] * rhs[i], product[i].matrix());
+		matches = matches && same(lhs[i].transpose(), transposed[i].matrix());
+		matches = matches && same(transform * lhs[i], transformed[i].matrix());
+		matches = matches && same(lhs[i] * transform, transformed_right[i].matrix());
+		matches = matches && same(lhs_other_order[i], converted_batch[i].template matrix<typename Order::transposed>());
+	}
+	EXPECT_TRUE(matches);
+
+	const auto round_trip = lhs_batch.to_vector();
+	ASSERT_EQ(round_trip.size(), count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		matches = matches && same(lhs[i], round_trip[i]);
+	}
+	EXPECT_TRUE(matches);
+}
+
+TEST(OperationsTests, SoABatch)
+{
+	for (const size_t count : { size_t{ 0 }, size_t{ 3 }, size_t{ 37 }, size_t{ 1000 } })
+	{
+		check_soa_batch<float, 4, 4, 4, RowMajor>(count);
+		check_soa_batch<double, 3, 3, 3, RowMajor>(count);
+		check_soa_batch<double, 2, 3, 4, ColumnMajor>(count);
+		check_soa_batch<int, 3, 2, 3, RowMajor>(count);
+	}
+
+	// Element arrays are aligned and padded past the matrices
+	{
+		SMatrixBatch<float, 4, 4> batch{ 1000 };
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(batch.data()) % cache_line_size, 0u);
+		EXPECT_EQ(batch.stride() * sizeof(float) % cache_line_size, 0u);
+		EXPECT_GE(batch.stride(), batch.size());
+		EXPECT_EQ(batch.element_data(0, 3), batch.data() + 3 * batch.stride());
+	}
+
+	// Element access through the references
+	{
+		SMatrixBatch<int, 2, 3, ColumnMajor> batch{ 5 };
+		batch[2] = SMatrix<int, 2, 3>{ 1, 2, 3, 4, 5, 6 };
+		batch[4] = batch[2];
+		batch.at(4)(1, 0) = 40;
+
+		const SMatrixBatch<int, 2, 3, ColumnMajor>& const_batch = batch;
+		const SMatrix<int, 2, 3, ColumnMajor> matrix = const_batch[4];
+		EXPECT_THAT(matrix, ::testing::ElementsAre(1, 40, 2, 5, 3, 6));
+		EXPECT_EQ(batch[2](1, 0), 4);
+		EXPECT_EQ(batch.element_data(1, 0)[4], 40);
+		EXPECT_THAT(batch[0].matrix(), ::testing::Each(0));
+		EXPECT_THROW(const_batch.at(5), Matrix_IndexOutOfBounds);
+
+		batch = std::move(batch) * 2;
+		batch += batch;
+		batch -= SMatrixBatch<int, 2, 3, ColumnMajor>{ 5 };
+		EXPECT_EQ(batch[4](1, 0), 160);
+	}
+
+	// Products written over one of their operands
+	{
+		const size_t count = 37;
+		const auto lhs = batch_test_matrices<double, 3, 3, ColumnMajor>(count, 1);
+		const auto rhs = batch_test_matrices<double, 3, 3, ColumnMajor>(count, 4);
+
+		SMatrixBatch<double, 3, 3, ColumnMajor> lhs_batch{ lhs.data(), count };
+		SMatrixBatch<double, 3, 3, ColumnMajor> rhs_batch{ rhs.data(), count };
+		batch_multiply(lhs_batch, rhs_batch, lhs_batch);
+		const SMatrixBatch<double, 3, 3, ColumnMajor> lhs_copy{ lhs.data(), count };
+		batch_multiply(lhs_copy, rhs_batch, rhs_batch);
+
+		bool matches = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const SMatrix<double, 3, 3, ColumnMajor> expected = lhs[i] * rhs[i];
+			const SMatrix<double, 3, 3, ColumnMajor> in_lhs = lhs_batch[i];
+			const SMatrix<double, 3, 3, ColumnMajor> in_rhs = rhs_batch[i];
+			matches = matches && std::equal(expected.begin(), expected.end(), in_lhs.begin());
+			matches = matches && std::equal(expected.begin(), expected.end(), in_rhs.begin());
+		}
+		EXPECT_TRUE(matches);
+	}
+
+	{
+		const SMatrixBatch<double, 2, 2> lhs{ 4 };
+		const SMatrixBatch<double, 2, 2> rhs{ 5 };
+		EXPECT_THROW(lhs + rhs, Matrix_BatchSizeMismatch);
+		EXPECT_THROW(lhs * rhs, Matrix_BatchSizeMismatch);
+	}
+
+	// Large batches split the products over the pool
+	{
+		ThreadPool::instance().resize(3);
+		check_soa_batch<float, 4, 4, 4, RowMajor>(20000);
+		ThreadPool::instance().resize(ThreadPool::default_worker_count());
+	}
+}
+
+template <class T, size_t N, class Order>
+void check_simd_kernels()
+{
+	SMatrix<T, N, N, Order> lhs{}, rhs{};
+	for (size_t i = 0; i < N * N; ++i)
+	{
+		lhs[i] = static_cast<T>(static_cast<int>(i * 5 % 7) - 3);
+		rhs[i] = static_cast<T>(static_cast<int>(i * 3 % 11) - 5);
+	}
+
+	SMatrix<T, N, N, Order> product{}, sum{}, difference{}, transposed{};
+	for (size_t row = 0; row < N; ++row)
+	{
+		for (size_t column = 0; column < N; ++column)
+		{
+			for (size_t k = 0; k < N; ++k)
+			{
+				product(row, column) += lhs(row, k) * rhs(k, column);
+			}
+
+			sum(row, column) = lhs(row, column) + rhs(row, column);
+			difference(row, column) = lhs(row, column) - rhs(row, column);
+			transposed(column, row) = lhs(row, column);
+		}
+	}
+
+	EXPECT_THAT(lhs * rhs, ::testing::ElementsAreArray(product));
+	EXPECT_THAT(lhs + rhs, ::testing::ElementsAreArray(sum));
+	EXPECT_THAT(lhs - rhs, ::testing::ElementsAreArray(difference));
+	EXPECT_THAT(lhs.transpose(), ::testing::ElementsAreArray(transposed));
+
+	SMatrix<T, N, N, Order> accumulator = lhs;
+	accumulator += rhs;
+	EXPECT_THAT(accumulator, ::testing::ElementsAreArray(sum));
+	accumulator -= rhs;
+	accumulator -= rhs;
+	EXPECT_THAT(accumulator, ::testing::ElementsAreArray(difference));
+}
+
+TEST(OperationsTests, SimdKernels)
+{
+	check_simd_kernels<float, 2, RowMajor>();
+	check_simd_kernels<float, 3, RowMajor>();
+	check_simd_kernels<float, 4, RowMajor>();
+	check_simd_kernels<double, 2, RowMajor>();
+	check_simd_kernels<double, 3, RowMajor>();
+	check_simd_kernels<double, 4, RowMajor>();
+	check_simd_kernels<float, 3, ColumnMajor>();
+	check_simd_kernels<double, 4, ColumnMajor>();
+
+	// Constant evaluation stays on the unrolled code
+	{
+		constexpr SMatrix<float, 2, 2> lhs{ 1, 2, 3, 4 };
+		constexpr SMatrix<float, 2, 2> rhs{ 5, 6, 7, 8 };
+		constexpr SMatrix<float, 2, 2> product = lhs * rhs;
+		constexpr SMatrix<float, 2, 2> transposed = (lhs + rhs).transpose();
+
+		static_assert(product(1, 0) == 43, "constexpr product");
+		static_assert(transposed(0, 1) == 10, "constexpr transpose");
+		EXPECT_THAT(product, ::testing::ElementsAre(19, 22, 43, 50));
+	}
+}
+
+TEST(OperationsTests, DeterminantAndInverse)
+{
+	{
+		constexpr SMatrix<double, 2, 2> matrix{ 4, 7, 2, 6 };
+		static_assert(determinant(matrix) == 10, "constexpr determinant");
+
+		EXPECT_THAT(inverse(matrix), ::testing::Pointwise(::testing::DoubleNear(1e-12), std::vector<double>{ 0.6, -0.7, -0.2, 0.4 }));
+	}
+
+	{
+		constexpr SMatrix<double, 3, 3> matrix{ 1, 2, 3, 0, 1, 4, 5, 6, 0 };
+		EXPECT_EQ(determinant(matrix), 1);
+		EXPECT_THAT(inverse(matrix), ::testing::ElementsAre(-24, 18, 5, 20, -15, -4, -5, 4, 1));
+
+		constexpr SMatrix<double, 3, 3, ColumnMajor> column_major{ 1, 0, 5, 2, 1, 6, 3, 4, 0 };
+		EXPECT_EQ(determinant(column_major), 1);
+		EXPECT_EQ(inverse(column_major)(0, 1), 18);
+	}
+
+	{
+		constexpr SMatrix<double, 4, 4> matrix{ 1, 0, 2, -1, 3, 0, 0, 5, 2, 1, 4, -3, 1, 0, 5, 0 };
+		EXPECT_EQ(determinant(matrix), 30);
+
+		const SMatrix<double, 4, 4> identity = matrix * inverse(matrix);
+		EXPECT_THAT(identity, ::testing::Pointwise(::testing::DoubleNear(1e-12), std::vector<double>{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }));
+
+		const SMatrix<float, 4, 4> float_matrix{ 2, 0, 0, 0, 0, 4, 0, 0, 0, 0, 8, 0, 1, 0, 0, 1 };
+		EXPECT_THAT(inverse(float_matrix), ::testing::ElementsAre(0.5f, 0, 0, 0, 0, 0.25f, 0, 0, 0, 0, 0.125f, 0, -0.5f, 0, 0, 1));
+	}
+
+	{
+		const SMatrix<float, 3, 3> singular{ 1, 2, 3, 2, 4, 6, 0, 1, 1 };
+		EXPECT_THROW(inverse(singular), Matrix_Singular);
+	}
+}
+
+// Everything below is evaluated by the compiler, the compound assignments included
+constexpr SMatrix<int, 2, 3> accumulate_compound(SMatrix<int, 2, 3> matrix)
+{
+	matrix += SMatrix<int, 2, 3>{ 1, 1, 1, 1, 1, 1 };
+	matrix -= SMatrix<int, 2, 3>{ 0, 1, 0, 1, 0, 1 };
+	matrix *= 2;
+	*matrix.begin() = -1;
+	return matrix;
+}
+
+constexpr SMatrix<int, 3, 3> power(const SMatrix<int, 3, 3>& matrix, const size_t exponent)
+{
+	SMatrix<int, 3, 3> result{ 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+	for (size_t i = 0; i < exponent; ++i)
+	{
+		result = result * matrix;
+	}
+
+	return result;
+}
+
+TEST(OperationsTests, ConstantEvaluation)
+{
+	{
+		constexpr SMatrix<int, 2, 3> matrix = accumulate_compound({ 1, 2, 3, 4, 5, 6 });
+
+		static_assert(matrix(0, 0) == -1 && matrix(0, 1) == 4 && matrix(1, 2) == 12, "constexpr compound assignment");
+		EXPECT_THAT(matrix, ::testing::ElementsAre(-1, 4, 8, 8, 12, 12));
+	}
+
+	// A lookup table built at compile time: powers of the Fibonacci step
+	{
+		constexpr SMatrix<int, 3, 3> step{ 1, 1, 0, 1, 0, 0, 0, 0, 1 };
+		constexpr SMatrix<int, 3, 3> table = power(step, 10);
+
+		static_assert(table(0, 1) == 55 && table(0, 0) == 89 && table(2, 2) == 1, "constexpr power");
+		EXPECT_EQ(table(1, 1), 34);
+	}
+
+	// Mixed storage orders, a non-square splice and transpose, and a float reduction
+	{
+		constexpr SMatrix<int, 2, 3, ColumnMajor> lhs{ 1, 4, 2, 5, 3, 6 };
+		constexpr SMatrix<int, 3, 4> rhs{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+		constexpr SMatrix<int, 2, 4, ColumnMajor> product = lhs * rhs;
+		constexpr SMatrix<int, 4, 2, ColumnMajor> transposed = product.transpose();
+		constexpr SMatrix<int, 2, 2, ColumnMajor> spliced = transposed.splice<1, 0, 2, 2>();
+
+		static_assert(product(0, 0) == 38 && product(1, 3) == 128, "constexpr mixed-order product");
+		static_assert(transposed(3, 1) == 128 && spliced(1, 1) == 113, "constexpr transpose and splice");
+		EXPECT_THAT(product, ::testing::ElementsAre(38, 83, 44, 98, 50, 113, 56, 128));
+
+		constexpr SMatrix<double, 1, 4> row{ 0.5, 0.25, 0.125, 0.125 };
+		constexpr SMatrix<double, 4, 1> column{ 1, 1, 1, 1 };
+		static_assert((row * column)(0, 0) == 1.0, "constexpr floating point reduction");
+	}
+
+	// Shapes beyond the register kernels agree with the loop definition at run time
+	{
+		SMatrix<double, 5, 7> lhs{};
+		SMatrix<double, 7, 6, ColumnMajor> rhs{};
+		for (size_t i = 0; i < lhs.size(); ++i)
+		{
+			lhs[i] = static_cast<double>(i % 11) - 5;
+		}
+		for (size_t i = 0; i < rhs.size(); ++i)
+		{
+			rhs[i] = static_cast<double>(i % 7) * 0.5;
+		}
+
+		const SMatrix<double, 5, 6> product = lhs * rhs;
+		for (size_t row = 0; row < 5; ++row)
+		{
+			for (size_t column = 0; column < 6; ++column)
+			{
+				double expected = 0;
+				for (size_t k = 0; k < 7; ++k)
+				{
+					expected += lhs(row, k) * rhs(k, column);
+				}
+				EXPECT_EQ(product(row, column), expected);
+			}
+		}
+	}
+}